@@ -0,0 +1,111 @@
+#include "DirectoryEnumerator.h"
+#include <filesystem>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+namespace core {
+
+#if defined(_WIN32)
+std::unique_ptr<DirectoryEnumerator> CreateWin32DirectoryEnumerator();
+#elif defined(__linux__)
+std::unique_ptr<DirectoryEnumerator> CreateLinuxDirectoryEnumerator();
+#endif
+
+namespace {
+
+const size_t kBatchSize = 512;
+
+void FillInfo(const fs::directory_entry& entry, DirEntryInfo& info) {
+    std::error_code status_ec;
+    bool is_directory = entry.is_directory(status_ec);
+    info.is_dir = !status_ec && is_directory;
+    if (entry.is_symlink(status_ec)) info.attributes |= kAttrSymlink;
+    if (!info.name.empty() && info.name[0] == '.') info.attributes |= kAttrHidden;
+
+    if (!info.is_dir) {
+        uintmax_t size = entry.file_size(status_ec);
+        info.size_known = !status_ec;
+        info.size = info.size_known ? size : 0;
+    }
+
+    auto write_time = entry.last_write_time(status_ec);
+    if (!status_ec) {
+        // file_time_type's epoch is unspecified in C++17, rebase onto system_clock
+        auto sys = std::chrono::system_clock::now() +
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(write_time - fs::file_time_type::clock::now());
+        info.mtime = std::chrono::duration_cast<std::chrono::seconds>(sys.time_since_epoch()).count();
+    }
+}
+
+class StdDirectoryEnumerator : public DirectoryEnumerator {
+public:
+    bool Enumerate(const std::string& path, const BatchCallback& on_batch, std::string& error) override {
+        std::error_code ec;
+        fs::directory_iterator it(path, ec);
+        if (ec) {
+            error = ec.message();
+            return false;
+        }
+
+        std::vector<DirEntryInfo> batch;
+        batch.reserve(kBatchSize);
+
+        for (; it != fs::directory_iterator(); it.increment(ec)) {
+            if (ec) {
+                error = ec.message();
+                break;
+            }
+            const auto& entry = *it;
+
+            DirEntryInfo info;
+            info.name = entry.path().filename().u8string();
+            FillInfo(entry, info);
+
+            batch.push_back(std::move(info));
+            if (batch.size() >= kBatchSize) {
+                if (!on_batch(batch)) return true;
+                batch.clear();
+            }
+        }
+
+        if (!batch.empty()) on_batch(batch);
+        return error.empty();
+    }
+
+    std::vector<DirEntryInfo> StatNames(const std::string& path, const std::vector<std::string>& names) override {
+        std::vector<DirEntryInfo> out;
+        for (const auto& name : names) {
+            std::error_code ec;
+            fs::path full = fs::u8path(path) / fs::u8path(name);
+            // symlink_status so dangling links still count as present
+            if (!fs::exists(fs::symlink_status(full, ec))) continue;
+            fs::directory_entry entry(full, ec);
+            DirEntryInfo info;
+            info.name = name;
+            FillInfo(entry, info);
+            out.push_back(std::move(info));
+        }
+        return out;
+    }
+
+    const char* Name() const override { return "std::filesystem"; }
+};
+
+}
+
+std::unique_ptr<DirectoryEnumerator> CreateStdDirectoryEnumerator() {
+    return std::make_unique<StdDirectoryEnumerator>();
+}
+
+std::unique_ptr<DirectoryEnumerator> CreateDirectoryEnumerator() {
+#if defined(_WIN32)
+    return CreateWin32DirectoryEnumerator();
+#elif defined(__linux__)
+    return CreateLinuxDirectoryEnumerator();
+#else
+    return CreateStdDirectoryEnumerator();
+#endif
+}
+
+}
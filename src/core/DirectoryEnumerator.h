@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+namespace core {
+
+// Portable attribute bits reported by the enumeration backends
+enum EntryAttribute : uint32_t {
+    kAttrHidden   = 1 << 0,
+    kAttrReadOnly = 1 << 1,
+    kAttrSystem   = 1 << 2,
+    kAttrSymlink  = 1 << 3,
+};
+
+struct DirEntryInfo {
+    std::string name;          // UTF-8, no directory part
+    uint64_t size = 0;
+    int64_t mtime = 0;         // Seconds since the Unix epoch
+    uint32_t attributes = 0;   // EntryAttribute bits
+    bool is_dir = false;
+    bool size_known = false;   // False when the entry could not be stat'ed
+};
+
+// Lists one directory level with as few syscalls per entry as the platform allows.
+class DirectoryEnumerator {
+public:
+    // Receives consecutive batches; return false to stop enumerating.
+    using BatchCallback = std::function<bool(const std::vector<DirEntryInfo>&)>;
+
+    virtual ~DirectoryEnumerator() = default;
+
+    // Returns false and fills error if the directory could not be read.
+    // Stopping early from the callback is not an error.
+    virtual bool Enumerate(const std::string& path, const BatchCallback& on_batch, std::string& error) = 0;
+
+    // Re-reads just the named entries of path (used to patch a listing after
+    // change notifications). Names that no longer exist are left out.
+    virtual std::vector<DirEntryInfo> StatNames(const std::string& path, const std::vector<std::string>& names) = 0;
+
+    virtual const char* Name() const = 0;
+};
+
+// Best backend for this platform (getdents64/statx on Linux,
+// FindFirstFileExW on Windows, std::filesystem elsewhere).
+std::unique_ptr<DirectoryEnumerator> CreateDirectoryEnumerator();
+
+// Portable std::filesystem backend, also used as a reference in tests
+std::unique_ptr<DirectoryEnumerator> CreateStdDirectoryEnumerator();
+
+}
@@ -0,0 +1,142 @@
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "DirectoryEnumerator.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+
+namespace core {
+
+namespace {
+
+// Layout returned by getdents64 (glibc does not export the struct)
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+const size_t kDentBufferSize = 256 * 1024;
+
+class LinuxDirectoryEnumerator : public DirectoryEnumerator {
+public:
+    bool Enumerate(const std::string& path, const BatchCallback& on_batch, std::string& error) override {
+        int dirfd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirfd < 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+
+        std::vector<char> buffer(kDentBufferSize);
+        std::vector<DirEntryInfo> batch;
+        std::vector<unsigned char> types;
+
+        while (true) {
+            long bytes = syscall(SYS_getdents64, dirfd, buffer.data(), buffer.size());
+            if (bytes < 0) {
+                error = std::strerror(errno);
+                break;
+            }
+            if (bytes == 0) break;
+
+            batch.clear();
+            types.clear();
+            for (long offset = 0; offset < bytes;) {
+                auto* dent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                offset += dent->d_reclen;
+
+                const char* name = dent->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+                DirEntryInfo info;
+                info.name = name;
+                if (name[0] == '.') info.attributes |= kAttrHidden;
+                batch.push_back(std::move(info));
+                types.push_back(dent->d_type);
+            }
+
+            // Stat the whole getdents buffer relative to the open directory:
+            // no path resolution, and no server round trip for cached metadata.
+            for (size_t i = 0; i < batch.size(); ++i) {
+                StatEntry(dirfd, types[i], batch[i]);
+            }
+
+            if (!batch.empty() && !on_batch(batch)) break;
+        }
+
+        close(dirfd);
+        return error.empty();
+    }
+
+    std::vector<DirEntryInfo> StatNames(const std::string& path, const std::vector<std::string>& names) override {
+        std::vector<DirEntryInfo> out;
+        int dirfd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirfd < 0) return out;
+
+        for (const auto& name : names) {
+            // No d_type here; an lstat-style probe tells files, dirs and links apart
+            struct statx stx;
+            if (statx(dirfd, name.c_str(), AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW, STATX_TYPE, &stx) != 0) continue;
+            unsigned char d_type = S_ISLNK(stx.stx_mode) ? DT_LNK : S_ISDIR(stx.stx_mode) ? DT_DIR : DT_REG;
+
+            DirEntryInfo info;
+            info.name = name;
+            if (name[0] == '.') info.attributes |= kAttrHidden;
+            StatEntry(dirfd, d_type, info);
+            out.push_back(std::move(info));
+        }
+
+        close(dirfd);
+        return out;
+    }
+
+    const char* Name() const override { return "getdents64+statx"; }
+
+private:
+    static void StatEntry(int dirfd, unsigned char d_type, DirEntryInfo& info) {
+        // d_type already answers "is it a directory" unless the filesystem
+        // does not report types or the entry is a link we have to follow.
+        bool follow = d_type == DT_LNK || d_type == DT_UNKNOWN;
+        if (d_type == DT_LNK) info.attributes |= kAttrSymlink;
+        info.is_dir = d_type == DT_DIR;
+
+        struct statx stx;
+        unsigned int mask = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME;
+        int flags = AT_STATX_DONT_SYNC | (follow ? 0 : AT_SYMLINK_NOFOLLOW);
+        if (statx(dirfd, info.name.c_str(), flags, mask, &stx) != 0) {
+            return;
+        }
+
+        if (follow && (stx.stx_mask & STATX_TYPE)) {
+            info.is_dir = S_ISDIR(stx.stx_mode);
+        }
+        if (!info.is_dir && (stx.stx_mask & STATX_SIZE)) {
+            info.size = stx.stx_size;
+            info.size_known = true;
+        }
+        if (stx.stx_mask & STATX_MTIME) {
+            info.mtime = stx.stx_mtime.tv_sec;
+        }
+        if ((stx.stx_mask & STATX_MODE) && !(stx.stx_mode & (S_IWUSR | S_IWGRP | S_IWOTH))) {
+            info.attributes |= kAttrReadOnly;
+        }
+    }
+};
+
+}
+
+std::unique_ptr<DirectoryEnumerator> CreateLinuxDirectoryEnumerator() {
+    return std::make_unique<LinuxDirectoryEnumerator>();
+}
+
+}
+#endif
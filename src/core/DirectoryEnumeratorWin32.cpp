@@ -0,0 +1,113 @@
+#if defined(_WIN32)
+#include "DirectoryEnumerator.h"
+#include "WideString.h"
+#include <windows.h>
+
+namespace core {
+
+namespace {
+
+const size_t kBatchSize = 512;
+
+// 100ns ticks between 1601-01-01 and 1970-01-01
+const uint64_t kUnixEpochTicks = 116444736000000000ULL;
+
+std::string LastErrorMessage() {
+    DWORD code = GetLastError();
+    char buf[256] = {0};
+    FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL, code, 0, buf, sizeof(buf), NULL);
+    return buf[0] ? std::string(buf) : "error " + std::to_string(code);
+}
+
+// Shared by FindFirstFileExW results and GetFileAttributesExW lookups
+void FillInfo(DWORD attrs, FILETIME write_time, DWORD size_high, DWORD size_low, DirEntryInfo& info) {
+    info.is_dir = (attrs & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    if (!info.is_dir) {
+        info.size = ((uint64_t)size_high << 32) | size_low;
+        info.size_known = true;
+    }
+
+    uint64_t ticks = ((uint64_t)write_time.dwHighDateTime << 32) | write_time.dwLowDateTime;
+    info.mtime = ticks > kUnixEpochTicks ? (int64_t)((ticks - kUnixEpochTicks) / 10000000ULL) : 0;
+
+    if (attrs & FILE_ATTRIBUTE_HIDDEN) info.attributes |= kAttrHidden;
+    if (attrs & FILE_ATTRIBUTE_READONLY) info.attributes |= kAttrReadOnly;
+    if (attrs & FILE_ATTRIBUTE_SYSTEM) info.attributes |= kAttrSystem;
+    if (attrs & FILE_ATTRIBUTE_REPARSE_POINT) info.attributes |= kAttrSymlink;
+}
+
+class Win32DirectoryEnumerator : public DirectoryEnumerator {
+public:
+    bool Enumerate(const std::string& path, const BatchCallback& on_batch, std::string& error) override {
+        std::wstring pattern = ToWide(path);
+        if (!pattern.empty() && pattern.back() != L'\\' && pattern.back() != L'/') pattern += L'\\';
+        pattern += L'*';
+
+        // Basic info skips the 8.3 short name; large fetch asks for bigger
+        // directory buffers per round trip, which matters most on shares.
+        WIN32_FIND_DATAW fd;
+        HANDLE find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &fd,
+                                       FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+        if (find == INVALID_HANDLE_VALUE) {
+            if (GetLastError() == ERROR_FILE_NOT_FOUND) return true; // Empty
+            error = LastErrorMessage();
+            return false;
+        }
+
+        std::vector<DirEntryInfo> batch;
+        batch.reserve(kBatchSize);
+
+        do {
+            const wchar_t* name = fd.cFileName;
+            if (name[0] == L'.' && (name[1] == L'\0' || (name[1] == L'.' && name[2] == L'\0'))) continue;
+
+            DirEntryInfo info;
+            ToUtf8(name, (int)wcslen(name), info.name);
+            FillInfo(fd.dwFileAttributes, fd.ftLastWriteTime, fd.nFileSizeHigh, fd.nFileSizeLow, info);
+
+            batch.push_back(std::move(info));
+            if (batch.size() >= kBatchSize) {
+                if (!on_batch(batch)) {
+                    FindClose(find);
+                    return true;
+                }
+                batch.clear();
+            }
+        } while (FindNextFileW(find, &fd));
+
+        if (GetLastError() != ERROR_NO_MORE_FILES) {
+            error = LastErrorMessage();
+        }
+        FindClose(find);
+
+        if (!batch.empty()) on_batch(batch);
+        return error.empty();
+    }
+
+    std::vector<DirEntryInfo> StatNames(const std::string& path, const std::vector<std::string>& names) override {
+        std::vector<DirEntryInfo> out;
+        std::wstring dir = ToWide(path);
+        if (!dir.empty() && dir.back() != L'\\' && dir.back() != L'/') dir += L'\\';
+
+        for (const auto& name : names) {
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (!GetFileAttributesExW((dir + ToWide(name)).c_str(), GetFileExInfoStandard, &data)) continue;
+            DirEntryInfo info;
+            info.name = name;
+            FillInfo(data.dwFileAttributes, data.ftLastWriteTime, data.nFileSizeHigh, data.nFileSizeLow, info);
+            out.push_back(std::move(info));
+        }
+        return out;
+    }
+
+    const char* Name() const override { return "FindFirstFileExW"; }
+};
+
+}
+
+std::unique_ptr<DirectoryEnumerator> CreateWin32DirectoryEnumerator() {
+    return std::make_unique<Win32DirectoryEnumerator>();
+}
+
+}
+#endif
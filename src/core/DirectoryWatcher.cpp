@@ -0,0 +1,92 @@
+#include "DirectoryWatcher.h"
+#include <algorithm>
+
+namespace core {
+
+#if defined(_WIN32)
+std::unique_ptr<DirectoryWatcher> CreateWin32DirectoryWatcher();
+#elif defined(__linux__)
+std::unique_ptr<DirectoryWatcher> CreateLinuxDirectoryWatcher();
+#endif
+
+namespace {
+
+// Deliver after this much quiet...
+const auto kQuietWindow = std::chrono::milliseconds(50);
+// ...but never hold a burst longer than this while changes keep coming
+const auto kMaxDelay = std::chrono::milliseconds(250);
+// Wait before offering a refused burst again
+const auto kRetryDelay = std::chrono::milliseconds(100);
+// Past this many distinct names a full re-read is cheaper than per-name stats
+const size_t kMaxNames = 4096;
+
+class NullDirectoryWatcher : public DirectoryWatcher {
+public:
+    bool Start(const std::string&, ChangeCallback, std::string& error) override {
+        error = "change notifications are not supported on this platform";
+        return false;
+    }
+    void Stop() override {}
+    const char* Name() const override { return "none"; }
+};
+
+}
+
+std::unique_ptr<DirectoryWatcher> CreateDirectoryWatcher() {
+#if defined(_WIN32)
+    return CreateWin32DirectoryWatcher();
+#elif defined(__linux__)
+    return CreateLinuxDirectoryWatcher();
+#else
+    return std::make_unique<NullDirectoryWatcher>();
+#endif
+}
+
+void ChangeCoalescer::Touch(Clock::time_point now) {
+    if (!HasPending()) first_event = now;
+    last_event = now;
+}
+
+void ChangeCoalescer::Add(std::string name, Clock::time_point now) {
+    Touch(now);
+    if (overflow) return;
+    names.insert(std::move(name));
+    if (names.size() > kMaxNames) {
+        names.clear();
+        overflow = true;
+    }
+}
+
+void ChangeCoalescer::SetOverflow(Clock::time_point now) {
+    Touch(now);
+    names.clear();
+    overflow = true;
+}
+
+ChangeCoalescer::Clock::time_point ChangeCoalescer::DueAt() const {
+    auto due = std::min(last_event + kQuietWindow, first_event + kMaxDelay);
+    return std::max(due, retry_at);
+}
+
+int ChangeCoalescer::TimeoutMs(Clock::time_point now) const {
+    if (!HasPending()) return -1;
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(DueAt() - now).count();
+    // Round up so we do not wake a millisecond early and spin
+    return wait <= 0 ? 0 : (int)wait + 1;
+}
+
+void ChangeCoalescer::DeliverIfDue(const DirectoryWatcher::ChangeCallback& on_changes, Clock::time_point now) {
+    if (!HasPending() || now < DueAt()) return;
+
+    WatchChanges changes;
+    changes.overflow = overflow;
+    changes.names.assign(names.begin(), names.end());
+    if (!on_changes(changes)) {
+        retry_at = now + kRetryDelay;
+        return;
+    }
+    names.clear();
+    overflow = false;
+}
+
+}
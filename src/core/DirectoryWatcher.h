@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_set>
+#include <chrono>
+
+namespace core {
+
+// Names touched since the last delivery. Create, delete, rename and modify
+// all reduce to "this name may have changed"; the receiver re-stats them.
+// overflow means the kernel dropped events and the whole folder must be
+// re-read.
+struct WatchChanges {
+    std::vector<std::string> names;
+    bool overflow = false;
+};
+
+// Watches one directory level on its own thread and delivers coalesced
+// bursts of changes, so a build writing thousands of files causes a handful
+// of updates instead of one per file.
+class DirectoryWatcher {
+public:
+    // Called on the watcher thread. Return false to keep the changes pending
+    // and have them offered again shortly (e.g. while a load is running).
+    using ChangeCallback = std::function<bool(const WatchChanges&)>;
+
+    virtual ~DirectoryWatcher() = default;
+
+    virtual bool Start(const std::string& path, ChangeCallback on_changes, std::string& error) = 0;
+    // Stops and joins the watcher thread; safe to call more than once
+    virtual void Stop() = 0;
+
+    virtual const char* Name() const = 0;
+};
+
+// inotify on Linux, ReadDirectoryChangesW on Windows. Elsewhere Start fails
+// and folders are only refreshed on demand.
+std::unique_ptr<DirectoryWatcher> CreateDirectoryWatcher();
+
+// De-duplicates raw notifications into bursts; shared by the backends.
+// A burst is delivered once the folder has been quiet for a short window,
+// or after a bounded delay while it keeps changing.
+class ChangeCoalescer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void Add(std::string name, Clock::time_point now);
+    void SetOverflow(Clock::time_point now);
+
+    bool HasPending() const { return overflow || !names.empty(); }
+    // Poll timeout until the pending burst is due; -1 when nothing is pending
+    int TimeoutMs(Clock::time_point now) const;
+    // Hands the burst to on_changes if it is due; keeps it if refused
+    void DeliverIfDue(const DirectoryWatcher::ChangeCallback& on_changes, Clock::time_point now);
+
+private:
+    void Touch(Clock::time_point now);
+    Clock::time_point DueAt() const;
+
+    std::unordered_set<std::string> names;
+    bool overflow = false;
+    Clock::time_point first_event;
+    Clock::time_point last_event;
+    Clock::time_point retry_at;
+};
+
+}
@@ -0,0 +1,112 @@
+#if defined(__linux__)
+#include "DirectoryWatcher.h"
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+
+namespace core {
+
+namespace {
+
+// Everything that can change what a listing row shows. IN_MODIFY fires per
+// write(), but the coalescer folds those into one name per burst.
+const uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+    IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+class LinuxDirectoryWatcher : public DirectoryWatcher {
+public:
+    ~LinuxDirectoryWatcher() override { Stop(); }
+
+    bool Start(const std::string& path, ChangeCallback on_changes, std::string& error) override {
+        Stop();
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd < 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        if (inotify_add_watch(inotify_fd, path.c_str(), kWatchMask) < 0) {
+            error = std::strerror(errno);
+            Close();
+            return false;
+        }
+        stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (stop_fd < 0) {
+            error = std::strerror(errno);
+            Close();
+            return false;
+        }
+        callback = std::move(on_changes);
+        thread = std::thread([this]() { Run(); });
+        return true;
+    }
+
+    void Stop() override {
+        if (thread.joinable()) {
+            uint64_t one = 1;
+            ssize_t ignored = write(stop_fd, &one, sizeof(one));
+            (void)ignored;
+            thread.join();
+        }
+        Close();
+    }
+
+    const char* Name() const override { return "inotify"; }
+
+private:
+    void Close() {
+        if (inotify_fd >= 0) close(inotify_fd);
+        if (stop_fd >= 0) close(stop_fd);
+        inotify_fd = stop_fd = -1;
+    }
+
+    void Run() {
+        // Aligned for struct inotify_event; holds many events per read()
+        alignas(struct inotify_event) char buffer[64 * 1024];
+        ChangeCoalescer pending;
+
+        while (true) {
+            pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+            int ready = poll(fds, 2, pending.TimeoutMs(ChangeCoalescer::Clock::now()));
+            if (ready < 0 && errno != EINTR) break;
+            if (fds[1].revents) break;
+
+            if (fds[0].revents & POLLIN) {
+                auto now = ChangeCoalescer::Clock::now();
+                ssize_t bytes;
+                while ((bytes = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + bytes;) {
+                        auto* event = reinterpret_cast<struct inotify_event*>(p);
+                        p += sizeof(struct inotify_event) + event->len;
+
+                        if (event->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                            pending.SetOverflow(now);
+                        } else if (event->len > 0) {
+                            pending.Add(event->name, now);
+                        }
+                    }
+                }
+            }
+
+            pending.DeliverIfDue(callback, ChangeCoalescer::Clock::now());
+        }
+    }
+
+    int inotify_fd = -1;
+    int stop_fd = -1;
+    ChangeCallback callback;
+    std::thread thread;
+};
+
+}
+
+std::unique_ptr<DirectoryWatcher> CreateLinuxDirectoryWatcher() {
+    return std::make_unique<LinuxDirectoryWatcher>();
+}
+
+}
+#endif
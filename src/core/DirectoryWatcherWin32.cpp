@@ -0,0 +1,117 @@
+#if defined(_WIN32)
+#include "DirectoryWatcher.h"
+#include "WideString.h"
+#include <windows.h>
+#include <thread>
+
+namespace core {
+
+namespace {
+
+const DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+    FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_ATTRIBUTES;
+
+// 64 KB is the most ReadDirectoryChangesW will fill on network shares
+const DWORD kBufferSize = 64 * 1024;
+
+class Win32DirectoryWatcher : public DirectoryWatcher {
+public:
+    ~Win32DirectoryWatcher() override { Stop(); }
+
+    bool Start(const std::string& path, ChangeCallback on_changes, std::string& error) override {
+        Stop();
+        dir = CreateFileW(ToWide(path).c_str(), FILE_LIST_DIRECTORY,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                          FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+        if (dir == INVALID_HANDLE_VALUE) {
+            error = "error " + std::to_string(GetLastError());
+            return false;
+        }
+        io_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+        stop_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+        callback = std::move(on_changes);
+        thread = std::thread([this]() { Run(); });
+        return true;
+    }
+
+    void Stop() override {
+        if (thread.joinable()) {
+            SetEvent(stop_event);
+            thread.join();
+        }
+        if (dir != INVALID_HANDLE_VALUE) CloseHandle(dir);
+        if (io_event) CloseHandle(io_event);
+        if (stop_event) CloseHandle(stop_event);
+        dir = INVALID_HANDLE_VALUE;
+        io_event = stop_event = NULL;
+    }
+
+    const char* Name() const override { return "ReadDirectoryChangesW"; }
+
+private:
+    bool Issue(OVERLAPPED& overlapped, DWORD* buffer) {
+        ResetEvent(io_event);
+        overlapped = OVERLAPPED();
+        overlapped.hEvent = io_event;
+        return ReadDirectoryChangesW(dir, buffer, kBufferSize, FALSE, kNotifyFilter, NULL, &overlapped, NULL) != 0;
+    }
+
+    void Run() {
+        // DWORD-aligned as FILE_NOTIFY_INFORMATION requires
+        std::vector<DWORD> buffer(kBufferSize / sizeof(DWORD));
+        OVERLAPPED overlapped;
+        ChangeCoalescer pending;
+        bool pending_io = Issue(overlapped, buffer.data());
+
+        while (true) {
+            HANDLE handles[2] = {stop_event, io_event};
+            int timeout = pending.TimeoutMs(ChangeCoalescer::Clock::now());
+            DWORD wait = WaitForMultipleObjects(pending_io ? 2 : 1, handles, FALSE,
+                                                timeout < 0 ? INFINITE : (DWORD)timeout);
+            if (wait == WAIT_OBJECT_0 || wait == WAIT_FAILED) break;
+
+            if (wait == WAIT_OBJECT_0 + 1) {
+                auto now = ChangeCoalescer::Clock::now();
+                DWORD bytes = 0;
+                if (!GetOverlappedResult(dir, &overlapped, &bytes, FALSE) || bytes == 0) {
+                    // Buffer overflowed (or the folder went away): rescan
+                    pending.SetOverflow(now);
+                } else {
+                    auto* base = reinterpret_cast<const char*>(buffer.data());
+                    for (DWORD offset = 0;;) {
+                        auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(base + offset);
+                        // Renames arrive as an old-name and a new-name record;
+                        // both are simply names whose state changed
+                        pending.Add(ToUtf8(info->FileName, (int)(info->FileNameLength / sizeof(WCHAR))), now);
+                        if (info->NextEntryOffset == 0) break;
+                        offset += info->NextEntryOffset;
+                    }
+                }
+                pending_io = Issue(overlapped, buffer.data());
+            }
+
+            pending.DeliverIfDue(callback, ChangeCoalescer::Clock::now());
+        }
+
+        if (pending_io) {
+            CancelIoEx(dir, &overlapped);
+            DWORD bytes;
+            GetOverlappedResult(dir, &overlapped, &bytes, TRUE);
+        }
+    }
+
+    HANDLE dir = INVALID_HANDLE_VALUE;
+    HANDLE io_event = NULL;
+    HANDLE stop_event = NULL;
+    ChangeCallback callback;
+    std::thread thread;
+};
+
+}
+
+std::unique_ptr<DirectoryWatcher> CreateWin32DirectoryWatcher() {
+    return std::make_unique<Win32DirectoryWatcher>();
+}
+
+}
+#endif
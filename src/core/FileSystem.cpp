@@ -1,23 +1,41 @@
 #include "FileSystem.h"
 #include "TabContext.h"
 #include "Logger.h"
+#include "Trace.h"
+#include "Metrics.h"
 #include "QuickAccess.h"
+#include "TaskScheduler.h"
+#include "DirectoryEnumerator.h"
+#include "ListingSort.h"
+#include "ListingSnapshot.h"
+#include "ListingCache.h"
+#include "DirectoryWatcher.h"
+#include "ListingSpill.h"
+#include "Session.h"
 #include <FL/Fl.H>
 #include <filesystem>
-#include <thread>
-#include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <cstdio>
+#include <ctime>
 #include <vector>
 #include <algorithm>
-#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#ifdef _WIN32
 #include <shlobj.h>
 #include <windows.h>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace core {
 
+// Streaming: the first batch is published as soon as it fills (or a slow
+// directory has had it pending for a few ms) so the table shows rows almost
+// immediately; later batches go out at most once per publish interval.
+static const size_t kFirstBatchSize = 256;
+static const auto kFirstPublishDelay = std::chrono::milliseconds(15);
+static const auto kPublishInterval = std::chrono::milliseconds(50);
+
 // Static callback to execute the context's update function on the main thread
 static void ContextUpdateCallback(void* data) {
     auto* context = static_cast<TabContext*>(data);
@@ -26,123 +44,646 @@ static void ContextUpdateCallback(void* data) {
     }
 }
 
+// Raises flags for the tab and wakes the UI only if none were pending, so
+// streaming a large folder costs one wakeup per UI drain, not per batch
+static void NotifyUI(TabContext* context, uint32_t flags) {
+    static Counter& awakes = Metrics::Get().GetCounter("ui.awakes");
+    if (context->updates.Post(flags)) {
+        awakes.Add();
+        Fl::awake(ContextUpdateCallback, context);
+    }
+}
+
+size_t FormatSize(uintmax_t size, char* buf, size_t buf_size) {
+    int n;
+    if (size < 1024) {
+        n = std::snprintf(buf, buf_size, "%llu B", (unsigned long long)size);
+    } else if (size < 1024 * 1024) {
+        n = std::snprintf(buf, buf_size, "%.1f KB", size / 1024.0);
+    } else {
+        n = std::snprintf(buf, buf_size, "%.1f MB", size / (1024.0 * 1024.0));
+    }
+    if (n < 0) return 0;
+    return std::min((size_t)n, buf_size ? buf_size - 1 : 0);
+}
+
 std::string FormatSize(uintmax_t size) {
-    if (size < 1024) return std::to_string(size) + " B";
-    if (size < 1024 * 1024) {
-        std::stringstream ss;
-        ss << std::fixed << std::setprecision(1) << (size / 1024.0) << " KB";
-        return ss.str();
+    char buf[32];
+    size_t n = FormatSize(size, buf, sizeof(buf));
+    return std::string(buf, n);
+}
+
+size_t FormatTime(int64_t unix_seconds, char* buf, size_t buf_size) {
+    if (buf_size == 0) return 0;
+    if (unix_seconds <= 0) {
+        buf[0] = '\0';
+        return 0;
     }
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(1) << (size / (1024.0 * 1024.0)) << " MB";
-    return ss.str();
+    std::time_t t = (std::time_t)unix_seconds;
+    std::tm tm;
+#ifdef _WIN32
+    if (localtime_s(&tm, &t) != 0) { buf[0] = '\0'; return 0; }
+#else
+    if (!localtime_r(&t, &tm)) { buf[0] = '\0'; return 0; }
+#endif
+    return std::strftime(buf, buf_size, "%Y-%m-%d %H:%M", &tm);
+}
+
+std::string JoinPath(const std::string& dir, const std::string& name) {
+    if (dir.empty()) return name;
+    char last = dir.back();
+    if (last == '/' || last == '\\') return dir + name;
+#ifdef _WIN32
+    return dir + '\\' + name;
+#else
+    return dir + '/' + name;
+#endif
+}
+
+bool WriteFileReplacing(const std::string& path, std::string_view data) {
+    std::string temp = path + ".tmp";
+    FILE* f = std::fopen(temp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = std::fclose(f) == 0 && ok;
+    std::error_code ec;
+    if (ok) fs::rename(temp, path, ec);
+    if (!ok || ec) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+using OrderPtr = std::shared_ptr<const std::vector<uint32_t>>;
+
+static OrderPtr SortedOrder(const Listing& files, const SortSpec& spec) {
+    TRACE_SPAN("Sort", "cpu");
+    auto order = std::make_shared<std::vector<uint32_t>>();
+    SortListing(files, spec, *order);
+    return order;
 }
 
-void LoadDirectoryWorker(std::string path, std::shared_ptr<TabContext> context) {
-    Log("Worker started for: " + path);
+// Swaps in a complete listing; the caller holds context->mutex and has
+// checked the generation. Re-sorts first if the user picked another column
+// since order was computed.
+static void PublishComplete(TabContext* context, std::shared_ptr<const Listing> files, OrderPtr order,
+                            const SortSpec& spec) {
+    TRACE_SPAN("PublishComplete", "nav");
+    if (!order || context->sort != spec) order = SortedOrder(*files, context->sort);
+    size_t count = files->size();
+    context->Publish(ListingSnapshot::Make(std::move(files), std::move(order), context->sort,
+                                           context->Snapshot()->version + 1));
+    context->status_text = std::to_string(count) + " items";
+}
+
+void LoadDirectoryWorker(std::string path, std::shared_ptr<TabContext> context, uint64_t generation) {
+    LOG_DEBUG("Worker started for: " + path);
+    TRACE_SPAN_DETAIL("LoadDirectory", "io", path);
+    static Counter& loads = Metrics::Get().GetCounter("load.count");
+    static Counter& entries = Metrics::Get().GetCounter("load.entries");
+    static Gauge& in_flight = Metrics::Get().GetGauge("load.in_flight");
+    static Histogram& load_time = Metrics::Get().GetHistogram("load.time");
+    loads.Add();
+    in_flight.Add(1);
+    ScopedTimer timer(load_time);
+    struct InFlight {
+        ~InFlight() { in_flight.Add(-1); }
+    } in_flight_guard;
+
+    // A newer StartLoading bumps the generation; this load is then stale and
+    // must neither publish nor touch the context again. Shutdown cancels too.
+    auto superseded = [&]() {
+        return context->generation.load() != generation || TaskScheduler::Get().IsStopping();
+    };
+
     try {
-        // Clear existing data
-        {
-            std::lock_guard<std::mutex> lock(context->mutex);
-            context->files.clear();
-            context->current_path = path;
-            context->status_text = "Loading...";
-        }
-        Fl::awake(ContextUpdateCallback, context.get());
+        // Taken before enumerating so changes made meanwhile fail revalidation
+        int64_t stamp = DirectoryChangeStamp(path);
 
-        std::vector<FileEntry> all_files;
-        all_files.reserve(4096);
+        // Entries not yet published; each publish freezes them into a part
+        // that the UI shares, so streaming never copies earlier rows
+        Listing pending(path);
+        std::vector<std::shared_ptr<const Listing>> parts;
+        size_t total = 0;
+        auto last_publish = std::chrono::steady_clock::now();
 
-        std::error_code ec;
-        int count = 0;
-        for (const auto& entry : fs::directory_iterator(path, ec)) {
-            if (ec) {
-                Log("Error accessing " + path + ": " + ec.message());
-                break; 
+        auto publish_batch = [&]() {
+            TRACE_SPAN("PublishBatch", "nav");
+            auto part = std::make_shared<const Listing>(std::move(pending));
+            pending = Listing(path);
+            parts.push_back(part);
+            total += part->size();
+            {
+                std::lock_guard<std::mutex> lock(context->mutex);
+                if (superseded()) return;
+                context->Publish(context->Snapshot()->WithPart(std::move(part)));
+                context->status_text = "Loading... " + std::to_string(total) + " items found";
             }
+            last_publish = std::chrono::steady_clock::now();
+            NotifyUI(context.get(), kUpdateRows | kUpdateStatus);
+        };
 
-            FileEntry fe;
-            try {
-                fe.path = entry.path().string();
-                fe.name = entry.path().filename().string();
-                
-                std::error_code status_ec;
-                bool is_directory = entry.is_directory(status_ec);
-                fe.is_dir = !status_ec && is_directory;
-
-                if (fe.is_dir) {
-                    fe.size_str = "<DIR>";
-                } else {
-                    uintmax_t size = entry.file_size(status_ec);
-                    fe.size_str = status_ec ? "Unknown" : FormatSize(size);
-                }
+        auto enumerator = CreateDirectoryEnumerator();
+        std::string error;
+        auto enumerate_span = std::make_unique<TraceSpan>("Enumerate", "io");
+        bool ok = enumerator->Enumerate(path, [&](const std::vector<DirEntryInfo>& batch) {
+            if (superseded()) return false;
 
-                all_files.push_back(fe);
-                count++;
-                
-                if (count % 1000 == 0) {
-                    context->status_text = "Loading... " + std::to_string(count) + " items found";
-                    Fl::awake(ContextUpdateCallback, context.get());
-                }
+            for (const auto& info : batch) {
+                pending.Append(info);
+            }
+            entries.Add(batch.size());
 
-            } catch (const std::exception& e) {
-                Log("Error processing entry: " + std::string(e.what()));
+            auto elapsed = std::chrono::steady_clock::now() - last_publish;
+            bool due = parts.empty()
+                ? (pending.size() >= kFirstBatchSize || elapsed >= kFirstPublishDelay)
+                : elapsed >= kPublishInterval;
+            if (due) {
+                publish_batch();
             }
+            return true;
+        }, error);
+        enumerate_span.reset();
+
+        if (superseded()) {
+            LOG_DEBUG("Load superseded, stopping: " + path);
+            return;
+        }
+        if (!ok) {
+            LOG_WARN("Error accessing " + path + ": " + error);
         }
 
-        // Sort
-        std::sort(all_files.begin(), all_files.end(), [](const FileEntry& a, const FileEntry& b) {
-            if (a.is_dir != b.is_dir) {
-                return a.is_dir > b.is_dir; 
-            }
-            return std::lexicographical_compare(
-                a.name.begin(), a.name.end(),
-                b.name.begin(), b.name.end(),
-                [](unsigned char c1, unsigned char c2) {
-                    return std::tolower(c1) < std::tolower(c2);
-                }
-            );
-        });
+        // Flush the tail so the unsorted listing is complete while we sort
+        if (!pending.empty()) {
+            publish_batch();
+        }
+
+        // Join the parts into one listing for sorting (a single part is used as is)
+        std::shared_ptr<const Listing> files;
+        if (parts.size() == 1) {
+            files = parts[0];
+        } else {
+            auto joined = std::make_shared<Listing>(path);
+            joined->reserve(total, total * 24);
+            for (const auto& part : parts) joined->Append(*part, 0, part->size());
+            files = std::move(joined);
+        }
+        parts.clear();
+
+        // Sort a view permutation; the listing itself is never moved
+        SortSpec spec;
+        {
+            std::lock_guard<std::mutex> lock(context->mutex);
+            spec = context->sort;
+        }
+        OrderPtr order = SortedOrder(*files, spec);
+
+        if (ok) {
+            ListingCache::Get().Store(path, {files, order, spec, stamp});
+        }
 
-        // Update state
+        // Replace the streamed (arrival order) rows with the sorted listing
         {
             std::lock_guard<std::mutex> lock(context->mutex);
-            context->files = std::move(all_files);
-            context->status_text = std::to_string(context->files.size()) + " items";
+            if (superseded()) return;
+            PublishComplete(context.get(), std::move(files), std::move(order), spec);
+            context->is_loading = false;
         }
 
     } catch (const std::exception& e) {
-        Log("Worker crashed: " + std::string(e.what()));
+        LOG_ERROR("Worker crashed: " + std::string(e.what()));
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (superseded()) return;
         context->status_text = "Error loading directory";
+        context->is_loading = false;
     } catch (...) {
-        Log("Worker crashed with unknown error");
+        LOG_ERROR("Worker crashed with unknown error");
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (superseded()) return;
         context->status_text = "Unknown error";
+        context->is_loading = false;
     }
 
-    context->is_loading = false;
-    Fl::awake(ContextUpdateCallback, context.get());
-    Log("Worker finished for: " + path);
+    NotifyUI(context.get(), kUpdateRows | kUpdateStatus | kUpdateState);
+    LOG_DEBUG("Worker finished for: " + path);
+}
+
+// Revisit path: the tab already shows the cached listing. If the directory
+// has not changed since it was taken we are done without touching the disk
+// again; otherwise re-enumerate and patch in only the differences, so rows
+// that did not change keep their place.
+void RevalidateWorker(std::string path, std::shared_ptr<TabContext> context, uint64_t generation,
+                      ListingCache::Entry cached) {
+    TRACE_SPAN_DETAIL("Revalidate", "io", path);
+    auto superseded = [&]() {
+        return context->generation.load() != generation || TaskScheduler::Get().IsStopping();
+    };
+
+    try {
+        SortSpec spec;
+        {
+            std::lock_guard<std::mutex> lock(context->mutex);
+            spec = context->sort;
+        }
+
+        int64_t stamp = DirectoryChangeStamp(path);
+        std::shared_ptr<const Listing> files = cached.listing;
+        OrderPtr order = cached.spec == spec ? cached.order : nullptr;
+
+        if (stamp == 0 || stamp != cached.stamp) {
+            Listing fresh(path);
+            fresh.reserve(files->size(), files->size() * 24);
+            auto enumerator = CreateDirectoryEnumerator();
+            std::string error;
+            bool ok = enumerator->Enumerate(path, [&](const std::vector<DirEntryInfo>& batch) {
+                if (superseded()) return false;
+                for (const auto& info : batch) fresh.Append(info);
+                return true;
+            }, error);
+            if (superseded()) return;
+            if (!ok) {
+                // Gone or no longer readable: drop the stale rows and fall back
+                // to a normal load, which reports the error
+                LOG_WARN("Revalidation failed for " + path + ": " + error);
+                ListingCache::Get().Invalidate(path);
+                {
+                    std::lock_guard<std::mutex> lock(context->mutex);
+                    if (superseded()) return;
+                    auto empty = std::make_shared<ListingSnapshot>();
+                    empty->version = context->Snapshot()->version + 1;
+                    context->Publish(std::move(empty));
+                }
+                LoadDirectoryWorker(path, context, generation);
+                return;
+            }
+
+            ListingDiff diff = DiffListings(*files, fresh);
+            LOG_DEBUG("Revalidated " + path + ": +" + std::to_string(diff.added.size()) +
+                " -" + std::to_string(diff.removed.size()) + " ~" + std::to_string(diff.changed.size()));
+            if (!diff.empty()) {
+                auto patched = std::make_shared<Listing>(*files);
+                // An empty order makes PatchListing sort from scratch
+                auto patched_order = std::make_shared<std::vector<uint32_t>>();
+                if (order) *patched_order = *order;
+                PatchListing(*patched, *patched_order, spec, fresh, diff);
+                files = std::move(patched);
+                order = std::move(patched_order);
+            }
+        }
+        if (!order) order = SortedOrder(*files, spec);
+        if (files != cached.listing || order != cached.order || stamp != cached.stamp) {
+            ListingCache::Get().Store(path, {files, order, spec, stamp});
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(context->mutex);
+            if (superseded()) return;
+            auto current = context->Snapshot();
+            if (current->Single() != files.get() || current->order != order || context->sort != spec) {
+                PublishComplete(context.get(), files, order, spec);
+            }
+            context->status_text = std::to_string(files->size()) + " items";
+            context->is_loading = false;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Revalidation crashed: " + std::string(e.what()));
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (superseded()) return;
+        context->is_loading = false;
+    }
+
+    NotifyUI(context.get(), kUpdateRows | kUpdateStatus | kUpdateState);
 }
 
 #include "QuickAccess.h"
 
 // ...
 
-void StartLoading(const std::string& path, std::shared_ptr<TabContext> context) {
-    if (context->is_loading) {
-        Log("Skipping load, already loading.");
-        return; 
+// Runs on the tab's watcher thread with one coalesced burst. Touched names
+// are re-stat'ed and patched into the listing at their sorted position;
+// after an overflow the folder is re-read and diffed instead.
+static bool ApplyDirectoryChanges(const std::string& path, TabContext* context, uint64_t generation,
+                                  const WatchChanges& changes) {
+    auto superseded = [&]() {
+        return context->generation.load() != generation || TaskScheduler::Get().IsStopping();
+    };
+    if (superseded()) return true;
+    // Let the running load publish first; these names are offered again
+    if (context->is_loading) return false;
+
+    auto current = context->Snapshot();
+    const Listing* base = current->Single();
+    if (!base) return true; // The load failed midway; nothing to patch
+
+    int64_t stamp = DirectoryChangeStamp(path);
+    auto enumerator = CreateDirectoryEnumerator();
+    Listing fresh(path);
+    if (changes.overflow) {
+        std::string error;
+        bool ok = enumerator->Enumerate(path, [&](const std::vector<DirEntryInfo>& batch) {
+            if (superseded()) return false;
+            for (const auto& info : batch) fresh.Append(info);
+            return true;
+        }, error);
+        if (!ok) {
+            LOG_WARN("Rescan after change overflow failed for " + path + ": " + error);
+            return true;
+        }
+    } else {
+        for (const auto& info : enumerator->StatNames(path, changes.names)) fresh.Append(info);
+    }
+
+    // Patch a private copy; the published snapshot stays untouched
+    ListingDiff diff = changes.overflow
+        ? DiffListings(*base, fresh)
+        : DiffListings(*base, fresh, changes.names);
+    if (diff.empty()) return true;
+
+    auto patched = std::make_shared<Listing>(*base);
+    auto order = std::make_shared<std::vector<uint32_t>>();
+    if (current->order) *order = *current->order;
+    PatchListing(*patched, *order, current->spec, fresh, diff);
+    std::shared_ptr<const Listing> files = std::move(patched);
+
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (superseded()) return true;
+        // Another writer got in first; redo against its snapshot
+        if (context->is_loading || context->Snapshot() != current) return false;
+        PublishComplete(context, files, order, current->spec);
+        // Keep the cache current so coming back later needs no rescan
+        ListingCache::Get().Store(path, {files, context->Snapshot()->order, context->sort, stamp});
+    }
+    NotifyUI(context, kUpdateRows | kUpdateStatus);
+    return true;
+}
+
+// Stopping joins the watcher thread, which may be waiting on the mutex, so
+// the watcher is taken out under the lock and destroyed outside it
+void StopWatching(std::shared_ptr<TabContext> context) {
+    std::unique_ptr<DirectoryWatcher> watcher;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        watcher = std::move(context->watcher);
+    }
+    watcher.reset();
+}
+
+static void StartWatching(const std::string& path, std::shared_ptr<TabContext> context, uint64_t generation) {
+    auto watcher = CreateDirectoryWatcher();
+    // The watcher is owned by the context and joined before it goes away,
+    // so a raw pointer cannot dangle (and cannot keep the context alive)
+    TabContext* raw = context.get();
+    std::string error;
+    bool ok = watcher->Start(path, [path, raw, generation](const WatchChanges& changes) {
+        return ApplyDirectoryChanges(path, raw, generation, changes);
+    }, error);
+    if (!ok) {
+        LOG_WARN("Not watching " + path + ": " + error);
+        return;
+    }
+    // A load begun on the pool can race a navigation; the newer one keeps
+    // its watcher. Whichever loses is joined outside the lock, since its
+    // thread may be waiting for the mutex.
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (context->generation == generation) std::swap(context->watcher, watcher);
+    }
+    watcher.reset();
+}
+
+// hit: cached holds a listing of path to show at once and revalidate.
+// A nonzero expected_generation makes this a no-op unless the tab is still
+// at it, so a load begun off the UI thread cannot undo a later navigation.
+static void BeginLoad(const std::string& path, std::shared_ptr<TabContext> context, bool hit,
+                      const ListingCache::Entry& cached, bool count_visit, uint64_t expected_generation = 0) {
+    // Supersede any in-flight load and reset the listing right away, so the
+    // new location shows on the next frame no matter how slow the old one is.
+    // A cache hit shows the remembered listing instead of an empty one.
+    // The old watcher is taken out after the bump, so a rescan it is running
+    // sees itself superseded and the join below does not wait for it.
+    uint64_t generation;
+    std::string spilled;
+    std::unique_ptr<DirectoryWatcher> old_watcher;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (expected_generation != 0 && context->generation != expected_generation) return;
+        generation = ++context->generation;
+        old_watcher = std::move(context->watcher);
+        spilled.swap(context->hibernation_file);
+        uint64_t version = context->Snapshot()->version + 1;
+        if (hit) {
+            // Arrival order until revalidation re-sorts for a different spec
+            OrderPtr order = cached.spec == context->sort ? cached.order : nullptr;
+            context->Publish(ListingSnapshot::Make(cached.listing, order, cached.spec, version));
+            context->status_text = std::to_string(cached.listing->size()) + " items";
+        } else {
+            auto empty = std::make_shared<ListingSnapshot>();
+            empty->version = version;
+            context->Publish(std::move(empty));
+            context->status_text = "Loading...";
+        }
+        context->current_path = path;
+        context->is_loading = true;
     }
-    context->is_loading = true;
-    Log("Requesting load for: " + path);
+    NotifyUI(context.get(), kUpdateAll);
+    old_watcher.reset();
+    if (!spilled.empty()) std::remove(spilled.c_str());
     
     // Track visit
-    QuickAccess::Get().AddVisit(path);
+    if (count_visit) QuickAccess::Get().AddVisit(path);
     
-    std::thread(LoadDirectoryWorker, path, context).detach();
+    // Watch before enumerating so nothing created meanwhile is missed
+    StartWatching(path, context, generation);
+
+    TaskPriority priority = context->is_active ? TaskPriority::ActiveTab : TaskPriority::BackgroundTab;
+    if (hit) {
+        TaskScheduler::Get().Submit(priority, [path, context, generation, cached]() {
+            RevalidateWorker(path, context, generation, cached);
+        });
+        return;
+    }
+    TaskScheduler::Get().Submit(priority, [path, context, generation]() {
+        LoadDirectoryWorker(path, context, generation);
+    });
 }
 
+void StartLoading(const std::string& path, std::shared_ptr<TabContext> context, bool use_cache,
+                  bool count_visit) {
+    TRACE_SPAN_DETAIL("StartLoading", "nav", path);
+    LOG_DEBUG("Requesting load for: " + path);
+
+    ListingCache::Entry cached;
+    bool hit = use_cache && ListingCache::Get().Lookup(path, cached);
+    if (!use_cache) ListingCache::Get().Invalidate(path);
+    BeginLoad(path, context, hit, cached, count_visit);
+}
+
+void ResortListing(std::shared_ptr<TabContext> context, SortSpec spec) {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (context->sort == spec) return;
+        context->sort = spec;
+        // A running load picks the new spec up when it sorts
+        if (context->is_loading) return;
+        generation = context->generation;
+    }
+
+    // Re-sorting only permutes the index array, the disk is never touched.
+    // The sort runs outside the lock and is redone if a watcher update
+    // replaced the listing in the meantime.
+    TaskScheduler::Get().Submit(TaskPriority::ActiveTab, [context, spec, generation]() {
+        while (true) {
+            auto current = context->Snapshot();
+            if (!current->Single()) return;
+            OrderPtr order = SortedOrder(*current->parts[0], spec);
+
+            std::lock_guard<std::mutex> lock(context->mutex);
+            if (context->generation != generation || context->sort != spec) return;
+            if (context->Snapshot() != current) continue;
+            context->Publish(ListingSnapshot::Make(current->parts[0], std::move(order), spec, current->version + 1));
+            break;
+        }
+        NotifyUI(context.get(), kUpdateRows);
+    });
+}
+
+void HibernateTab(std::shared_ptr<TabContext> context, const std::string& file) {
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (context->hibernation_queued || !context->hibernation_file.empty()) return;
+        context->hibernation_queued = true;
+    }
+    TaskScheduler::Get().Submit(TaskPriority::Indexing, [context, file]() {
+        TRACE_SPAN("Hibernate", "io");
+        std::string path;
+        uint64_t generation;
+        std::shared_ptr<const ListingSnapshot> snapshot;
+        auto abandoned = [&]() {
+            return context->generation != generation || context->is_active || context->is_loading ||
+                context->Snapshot() != snapshot;
+        };
+        {
+            std::lock_guard<std::mutex> lock(context->mutex);
+            context->hibernation_queued = false;
+            path = context->current_path;
+            generation = context->generation;
+            snapshot = context->Snapshot();
+            if (context->is_active || context->is_loading || !snapshot->Single()) return;
+        }
+
+        // Taken before writing: a change after it moves the stamp, so waking
+        // revalidates; one before it was patched in, or abandons below
+        int64_t stamp = DirectoryChangeStamp(path);
+        if (!WriteListingSpill(file, *snapshot->parts[0], snapshot->order.get(), snapshot->spec)) {
+            LOG_WARN("Could not hibernate " + path + " to " + file);
+            return;
+        }
+
+        std::unique_ptr<DirectoryWatcher> watcher;
+        {
+            std::lock_guard<std::mutex> lock(context->mutex);
+            if (abandoned() || !context->hibernation_file.empty()) {
+                std::remove(file.c_str());
+                return;
+            }
+            context->hibernation_file = file;
+            context->hibernation_stamp = stamp;
+            // Stops the watcher's patches; the listing goes with the snapshot
+            ++context->generation;
+            auto empty = std::make_shared<ListingSnapshot>();
+            empty->version = snapshot->version + 1;
+            context->Publish(std::move(empty));
+            watcher = std::move(context->watcher);
+        }
+        watcher.reset();
+        // The cache shares the listing and would keep it alive. An entry for
+        // the same folder that another tab stored is left alone.
+        ListingCache::Get().Invalidate(path, snapshot->parts[0].get());
+        LOG_DEBUG("Hibernated " + path);
+        NotifyUI(context.get(), kUpdateRows);
+    });
+}
+
+bool WakeTab(std::shared_ptr<TabContext> context) {
+    TRACE_SPAN("WakeTab", "nav");
+    static Histogram& wake_time = Metrics::Get().GetHistogram("tabs.wake");
+    ScopedTimer timer(wake_time);
+    std::string path;
+    std::string file;
+    int64_t stamp;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        if (context->hibernation_file.empty()) return false;
+        path = context->current_path;
+        file = context->hibernation_file;
+        stamp = context->hibernation_stamp;
+    }
+
+    // Shown on the next frame like a cache hit and revalidated against the
+    // stamp; loading also removes the file. Handed to the load directly and
+    // not put back in the cache, which hibernating took it out of.
+    SpilledListing spill;
+    bool ok = ReadListingSpill(file, spill);
+    if (ok && ListingCache::CanonicalKey(spill.listing->Parent()) != ListingCache::CanonicalKey(path)) {
+        // Someone replaced the file; its rows would resolve to another folder
+        LOG_WARN("Hibernated listing of " + path + " holds " + spill.listing->Parent() + ", reloading");
+        ok = false;
+    } else if (!ok) {
+        LOG_WARN("Hibernated listing of " + path + " is gone, reloading");
+    }
+    if (!ok) spill = SpilledListing();
+    ListingCache::Entry entry{spill.listing, spill.order, spill.spec, stamp};
+    BeginLoad(path, context, ok, entry, false);
+    return true;
+}
+
+void RestoreTab(const SessionTab& saved, std::shared_ptr<TabContext> context) {
+    // An unknown change stamp: files may have changed while the app was closed
+    // in ways the folder's own stamp does not show, so every restored listing
+    // is re-read and diffed
+    if (!saved.encoded) {
+        BeginLoad(saved.path, context, saved.listing != nullptr, {saved.listing, saved.order, saved.sort, 0}, false);
+        return;
+    }
+
+    // Decoding a large listing takes milliseconds, which the first frame
+    // should not wait for; the tab reads as loading until it is done
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        generation = ++context->generation;
+        auto empty = std::make_shared<ListingSnapshot>();
+        empty->version = context->Snapshot()->version + 1;
+        context->Publish(std::move(empty));
+        context->current_path = saved.path;
+        context->status_text = "Loading...";
+        context->is_loading = true;
+    }
+    NotifyUI(context.get(), kUpdateAll);
+
+    TaskPriority priority = context->is_active ? TaskPriority::ActiveTab : TaskPriority::BackgroundTab;
+    TaskScheduler::Get().Submit(priority, [saved, context, generation]() {
+        TRACE_SPAN_DETAIL("RestoreTab", "io", saved.path);
+        if (context->generation != generation) return;
+        SessionTab tab = saved;
+        if (!DecodeSessionTab(tab)) LOG_WARN("Saved listing of " + tab.path + " is damaged, reloading");
+        BeginLoad(tab.path, context, tab.listing != nullptr, {tab.listing, tab.order, tab.sort, 0}, false, generation);
+    });
+}
+
+static std::string FindConfigDir();
+
 std::string GetConfigDir() {
+    // Looked up and created once; startup asks for it from several threads
+    static const std::string dir = FindConfigDir();
+    return dir;
+}
+
+#ifdef _WIN32
+static std::string FindConfigDir() {
     std::string appData = GetKnownFolderPath(&FOLDERID_RoamingAppData);
     if (!appData.empty()) {
         std::string dir = appData + "\\FlashExplorer";
@@ -166,5 +707,25 @@ std::string GetKnownFolderPath(const void* rfid) {
     }
     return "";
 }
+#else
+static std::string FindConfigDir() {
+    // XDG base directory spec, falling back to ~/.config
+    std::string base;
+    if (const char* xdg = std::getenv("XDG_CONFIG_HOME")) base = xdg;
+    else if (const char* home = std::getenv("HOME")) base = std::string(home) + "/.config";
+    if (!base.empty()) {
+        std::string dir = base + "/FlashExplorer";
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+        return dir;
+    }
+    return ".";
+}
+
+std::string GetKnownFolderPath(const void*) {
+    // Known folder IDs are a Windows shell concept
+    return "";
+}
+#endif
 
 }
@@ -1,12 +1,44 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <memory>
+#include <cstddef>
 
 namespace core {
     struct TabContext;
-    void StartLoading(const std::string& path, std::shared_ptr<TabContext> context);
+    struct SortSpec;
+    struct SessionTab;
+    // Revisits paint from ListingCache and revalidate in the background;
+    // use_cache = false forces a fresh enumeration (explicit refresh);
+    // count_visit = false keeps it out of Quick Access (restored tabs)
+    void StartLoading(const std::string& path, std::shared_ptr<TabContext> context, bool use_cache = true,
+                      bool count_visit = true);
+    // Stops change notifications for the context's folder (tab closing)
+    void StopWatching(std::shared_ptr<TabContext> context);
+    // Re-orders the current listing by spec without re-enumerating
+    void ResortListing(std::shared_ptr<TabContext> context, SortSpec spec);
+    // Spills a hidden tab's finished listing to file on the pool and drops it
+    // from memory; the tab shows no rows until WakeTab. Gives up if the tab
+    // is shown, navigates or is loading by then.
+    void HibernateTab(std::shared_ptr<TabContext> context, const std::string& file);
+    // Shows a hibernated listing again and revalidates it like a cached one
+    // (a missing file means a normal load). False if it was not hibernated.
+    bool WakeTab(std::shared_ptr<TabContext> context);
+    // Opens a tab from the last session (see Session.h) with its saved
+    // listing, decoding it on the pool first if it is still encoded, and
+    // revalidates that like a cached one. Without a listing it loads normally.
+    void RestoreTab(const SessionTab& saved, std::shared_ptr<TabContext> context);
     std::string FormatSize(uintmax_t size);
+    // Allocation-free variants for the draw path; return the length written
+    size_t FormatSize(uintmax_t size, char* buf, size_t buf_size);
+    size_t FormatTime(int64_t unix_seconds, char* buf, size_t buf_size);
+    // Appends name to dir with the platform separator unless dir already ends in one
+    std::string JoinPath(const std::string& dir, const std::string& name);
+    // Writes data beside path and renames it over path, so a reader sees the
+    // old file or the new one but never half of either. False on failure,
+    // with path untouched.
+    bool WriteFileReplacing(const std::string& path, std::string_view data);
     std::string GetConfigDir();
     std::string GetKnownFolderPath(const void* rfid);
 }
@@ -0,0 +1,121 @@
+#include "FrecencyIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace core {
+
+namespace {
+
+const double kDecayRate = std::log(2.0) / FrecencyIndex::kHalfLifeSeconds;
+
+// ln(e^a + e^b) without overflowing
+double LogAddExp(double a, double b) {
+    if (a < b) std::swap(a, b);
+    return a + std::log1p(std::exp(b - a));
+}
+
+}
+
+double FrecencyIndex::VisitKey(int64_t when) {
+    return kDecayRate * static_cast<double>(when);
+}
+
+double FrecencyIndex::Score(const Entry& entry, int64_t now) {
+    return std::exp(entry.key - VisitKey(now));
+}
+
+void FrecencyIndex::Swap(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    heap_pos[heap[a]] = a;
+    heap_pos[heap[b]] = b;
+}
+
+void FrecencyIndex::SiftUp(size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!Above(pos, parent)) break;
+        Swap(pos, parent);
+        pos = parent;
+    }
+}
+
+void FrecencyIndex::SiftDown(size_t pos) {
+    for (;;) {
+        size_t best = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if (left < heap.size() && Above(left, best)) best = left;
+        if (right < heap.size() && Above(right, best)) best = right;
+        if (best == pos) break;
+        Swap(pos, best);
+        pos = best;
+    }
+}
+
+size_t FrecencyIndex::Insert(const std::string& path) {
+    auto it = index.find(path);
+    if (it != index.end()) return it->second;
+    size_t i = entries.size();
+    entries.emplace_back();
+    entries[i].path = path;
+    entries[i].key = -HUGE_VAL; // No visits yet
+    index.emplace(path, i);
+    heap_pos.push_back(heap.size());
+    heap.push_back(i);
+    return i;
+}
+
+void FrecencyIndex::Visit(const std::string& path, int64_t when) {
+    size_t i = Insert(path);
+    Entry& entry = entries[i];
+    entry.count++;
+    entry.last_visit = std::max(entry.last_visit, when);
+    double visit = VisitKey(when);
+    entry.key = entry.count == 1 ? visit : LogAddExp(entry.key, visit);
+    // Keys only grow
+    SiftUp(heap_pos[i]);
+}
+
+void FrecencyIndex::Set(const Entry& entry) {
+    size_t i = Insert(entry.path);
+    entries[i] = entry;
+    SiftUp(heap_pos[i]);
+    SiftDown(heap_pos[i]);
+}
+
+void FrecencyIndex::Clear() {
+    entries.clear();
+    heap_pos.clear();
+    heap.clear();
+    index.clear();
+}
+
+const FrecencyIndex::Entry* FrecencyIndex::Find(const std::string& path) const {
+    auto it = index.find(path);
+    return it != index.end() ? &entries[it->second] : nullptr;
+}
+
+std::vector<const FrecencyIndex::Entry*> FrecencyIndex::Top(
+    size_t k, const std::function<bool(const Entry&)>& skip) const {
+    std::vector<const Entry*> result;
+    if (heap.empty() || k == 0) return result;
+
+    // The next best entry is always a child of one already taken, so only
+    // the frontier needs ordering
+    auto lower = [this](size_t a, size_t b) { return entries[heap[a]].key < entries[heap[b]].key; };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(lower)> frontier(lower);
+    frontier.push(0);
+    while (!frontier.empty() && result.size() < k) {
+        size_t pos = frontier.top();
+        frontier.pop();
+        const Entry& entry = entries[heap[pos]];
+        if (!skip || !skip(entry)) result.push_back(&entry);
+        size_t left = 2 * pos + 1;
+        if (left < heap.size()) frontier.push(left);
+        if (left + 1 < heap.size()) frontier.push(left + 1);
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+namespace core {
+
+// Paths ranked by visit frequency and recency. Each visit adds 1 and the
+// total halves every kHalfLifeSeconds.
+//
+// The score is kept in the log domain against a fixed epoch,
+// key = ln(sum over visits of e^(lambda * t)). Decay then scales every
+// score alike, so the order only changes on a visit and an indexed max-heap
+// on key stays valid between visits. Top(k) walks the heap from the root in
+// O(k log k).
+class FrecencyIndex {
+public:
+    struct Entry {
+        std::string path;
+        int count = 0;
+        int64_t last_visit = 0; // Unix seconds
+        double key = 0;
+    };
+
+    static constexpr double kHalfLifeSeconds = 14.0 * 24 * 3600;
+
+    void Visit(const std::string& path, int64_t when);
+    // Restores an entry as saved; replaces any existing one
+    void Set(const Entry& entry);
+    void Clear();
+
+    const Entry* Find(const std::string& path) const;
+    size_t size() const { return entries.size(); }
+    // Unordered, for saving
+    const std::vector<Entry>& Entries() const { return entries; }
+
+    // Highest first, leaving out entries skip returns true for
+    std::vector<const Entry*> Top(size_t k, const std::function<bool(const Entry&)>& skip = nullptr) const;
+
+    // Decayed score at now: 1 for a single visit just made
+    static double Score(const Entry& entry, int64_t now);
+    // Key of a score of 1 at when
+    static double VisitKey(int64_t when);
+
+private:
+    std::vector<Entry> entries;
+    std::vector<size_t> heap_pos; // Per entry
+    std::vector<size_t> heap; // Entry indices, max-heap on key
+    std::unordered_map<std::string, size_t> index;
+
+    bool Above(size_t a, size_t b) const { return entries[heap[a]].key > entries[heap[b]].key; }
+    void Swap(size_t a, size_t b);
+    void SiftUp(size_t pos);
+    void SiftDown(size_t pos);
+    size_t Insert(const std::string& path);
+};
+
+}
@@ -0,0 +1,257 @@
+#include "IconDiskCache.h"
+#include "FileSystem.h"
+#include "ListingCache.h"
+#include <chrono>
+#include <cstring>
+
+namespace core {
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct RecordHeader {
+    uint16_t key_length;
+    uint8_t large;
+    uint8_t reserved;
+    uint16_t width;
+    uint16_t height;
+    int64_t written;
+};
+
+const char kMagic[4] = {'F', 'X', 'I', 'C'};
+
+int64_t NowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string SlotKey(const std::string& key, bool large) {
+    return (large ? "L" : "S") + key;
+}
+
+}
+
+IconDiskCache& IconDiskCache::Get() {
+    static IconDiskCache instance(GetConfigDir() + "/icon_cache.bin");
+    return instance;
+}
+
+IconDiskCache::IconDiskCache(const std::string& path, TaskScheduler& scheduler)
+    : state(std::make_shared<State>()), scheduler(scheduler) {
+    state->path = path;
+}
+
+IconDiskCache::~IconDiskCache() {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->on_ready = nullptr;
+    }
+    // Icons stored after the last write-behind would otherwise be lost
+    Flush();
+}
+
+std::string IconDiskCache::TypeKey(IconId id) {
+    if (id == kIconFolder) return "type:/";
+    return "type:" + IconTypeExtension(id);
+}
+
+std::string IconDiskCache::PathKey(const std::string& path) {
+    return "path:" + ListingCache::CanonicalKey(path);
+}
+
+void IconDiskCache::Open() {
+    if (Ready() || state->load_queued.exchange(true)) return;
+    std::shared_ptr<State> shared = state;
+    scheduler.Submit(TaskPriority::Prefetch, [shared]() { LoadState(*shared); });
+}
+
+void IconDiskCache::Load() {
+    LoadState(*state);
+}
+
+// Maps and indexes the file outside state.mutex, so lookups and stores on
+// the UI thread never wait for it; the pixels stay in the mapping until a flush
+void IconDiskCache::LoadState(State& state) {
+    std::lock_guard<std::mutex> load_lock(state.load_mutex);
+    if (state.ready.load(std::memory_order_acquire)) return;
+
+    std::unordered_map<std::string, Icon> icons;
+    if (state.file.Open(state.path)) {
+        const uint8_t* p = state.file.data();
+        const uint8_t* end = p + state.file.size();
+        FileHeader header;
+        bool valid = state.file.size() >= sizeof(header);
+        if (valid) {
+            std::memcpy(&header, p, sizeof(header));
+            valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion;
+            p += sizeof(header);
+        }
+        for (uint32_t i = 0; valid && i < header.count; ++i) {
+            RecordHeader record;
+            if (static_cast<size_t>(end - p) < sizeof(record)) break;
+            std::memcpy(&record, p, sizeof(record));
+            p += sizeof(record);
+            size_t pixel_bytes = static_cast<size_t>(record.width) * record.height * 4;
+            if (static_cast<size_t>(end - p) < record.key_length + pixel_bytes) break; // Truncated
+
+            std::string key(reinterpret_cast<const char*>(p), record.key_length);
+            p += record.key_length;
+            Icon icon;
+            icon.width = record.width;
+            icon.height = record.height;
+            icon.written = record.written;
+            icon.pixels = p;
+            p += pixel_bytes;
+            icons.emplace(SlotKey(key, record.large != 0), icon);
+        }
+        if (!valid) state.file.Close();
+    }
+
+    std::function<void()> notify;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        // Icons stored this run are newer than the file
+        for (auto& entry : icons) state.icons.emplace(entry.first, entry.second);
+        state.ready.store(true, std::memory_order_release);
+        notify = state.on_ready;
+    }
+    if (notify) notify();
+}
+
+void IconDiskCache::SetReadyCallback(std::function<void()> cb) {
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->on_ready = cb;
+        ready = Ready();
+    }
+    if (ready && cb) cb();
+}
+
+bool IconDiskCache::Lookup(const std::string& key, bool large, IconBitmap& out, bool* stale) {
+    if (stale) *stale = false;
+    if (!Ready()) {
+        Open();
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    auto it = state->icons.find(SlotKey(key, large));
+    if (it == state->icons.end()) return false;
+    Icon& icon = it->second;
+    if (stale && !icon.revalidating && NowSeconds() - icon.written > kStaleSeconds) {
+        icon.revalidating = true;
+        *stale = true;
+    }
+
+    out.Allocate(icon.width, icon.height);
+    std::memcpy(out.rgba.get(), icon.owned ? icon.owned->data() : icon.pixels, out.ByteSize());
+    return true;
+}
+
+void IconDiskCache::Store(const std::string& key, bool large, const IconBitmap& bitmap) {
+    if (!bitmap.rgba || bitmap.width <= 0 || bitmap.height <= 0 ||
+        bitmap.width > UINT16_MAX || bitmap.height > UINT16_MAX || key.size() > UINT16_MAX) {
+        return;
+    }
+    Icon icon;
+    icon.width = bitmap.width;
+    icon.height = bitmap.height;
+    icon.written = NowSeconds();
+    icon.owned = std::make_shared<const std::vector<uint8_t>>(
+        bitmap.rgba.get(), bitmap.rgba.get() + bitmap.ByteSize());
+
+    // The file need not be loaded yet: loading keeps what is stored here
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->icons[SlotKey(key, large)] = icon;
+    state->dirty = true;
+    if (state->flush_queued) return;
+    // One write covers everything stored until it runs
+    state->flush_queued = true;
+    std::shared_ptr<State> shared = state;
+    scheduler.Submit(TaskPriority::Indexing, [shared]() { FlushState(*shared); });
+}
+
+bool IconDiskCache::Flush() {
+    return FlushState(*state);
+}
+
+bool IconDiskCache::FlushState(State& state) {
+    // Flushes share the temp file name, and the newest snapshot must land last
+    static std::mutex write_mutex;
+    std::lock_guard<std::mutex> write_lock(write_mutex);
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.flush_queued = false;
+        if (!state.dirty) return true;
+    }
+    // What the file holds is written back too
+    LoadState(state);
+    std::vector<std::pair<std::string, Icon>> icons;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.dirty) return true;
+        state.dirty = false;
+
+        // Move mapped pixels into memory so the file can be replaced
+        int64_t now = NowSeconds();
+        for (auto it = state.icons.begin(); it != state.icons.end();) {
+            Icon& icon = it->second;
+            if (now - icon.written > kMaxAgeSeconds) {
+                it = state.icons.erase(it);
+                continue;
+            }
+            if (!icon.owned) {
+                size_t bytes = static_cast<size_t>(icon.width) * icon.height * 4;
+                icon.owned = std::make_shared<const std::vector<uint8_t>>(icon.pixels, icon.pixels + bytes);
+                icon.pixels = nullptr;
+            }
+            icons.emplace_back(it->first, icon);
+            ++it;
+        }
+        state.file.Close();
+    }
+
+    std::string data;
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = static_cast<uint32_t>(icons.size());
+    header.reserved = 0;
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& entry : icons) {
+        const Icon& icon = entry.second;
+        RecordHeader record;
+        record.key_length = static_cast<uint16_t>(entry.first.size() - 1); // Without the size prefix
+        record.large = entry.first[0] == 'L';
+        record.reserved = 0;
+        record.width = static_cast<uint16_t>(icon.width);
+        record.height = static_cast<uint16_t>(icon.height);
+        record.written = icon.written;
+        data.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        data.append(entry.first.data() + 1, record.key_length);
+        data.append(reinterpret_cast<const char*>(icon.owned->data()), icon.owned->size());
+    }
+
+    if (!WriteFileReplacing(state.path, data)) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.dirty = true; // Try again with the next store
+        return false;
+    }
+    return true;
+}
+
+size_t IconDiskCache::EntryCount() {
+    LoadState(*state);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->icons.size();
+}
+
+}
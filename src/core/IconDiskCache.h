@@ -0,0 +1,95 @@
+#pragma once
+#include "IconProvider.h"
+#include "MappedFile.h"
+#include "TaskScheduler.h"
+#include <string>
+#include <unordered_map>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+namespace core {
+
+// Icons from earlier runs, so a warm start draws without asking the shell.
+// One file in GetConfigDir(), mapped read-only and indexed on the pool;
+// lookups miss until that is done rather than wait for it. Icons stored
+// during the run are written behind on the pool at Indexing priority with
+// WriteFileReplacing.
+//
+// File: header, then per icon a record header, the key bytes and
+// width * height * 4 bytes of RGBA. A bad magic or version reads as empty.
+class IconDiskCache {
+public:
+    static IconDiskCache& Get();
+
+    explicit IconDiskCache(const std::string& path, TaskScheduler& scheduler = TaskScheduler::Get());
+    ~IconDiskCache();
+
+    // Keys survive restarts, unlike IconIds
+    static std::string TypeKey(IconId id);
+    static std::string PathKey(const std::string& path);
+
+    // Queues the file to be mapped on the pool; Load does it here instead
+    void Open();
+    void Load();
+    bool Ready() const { return state->ready.load(std::memory_order_acquire); }
+    // Called once the file is mapped, on whichever thread mapped it; keep it
+    // cheap (typically an Fl::awake). Runs at once if that already happened.
+    void SetReadyCallback(std::function<void()> cb);
+
+    // Copies the pixels into out; never blocks on the file (misses and
+    // calls Open until it is ready). Entries older than kStaleSeconds still
+    // hit, but set stale (once per run) so the caller asks the shell again
+    // and stores what it gets, picking up changed associations.
+    bool Lookup(const std::string& key, bool large, IconBitmap& out, bool* stale = nullptr);
+    void Store(const std::string& key, bool large, const IconBitmap& bitmap);
+
+    // Writes pending icons now instead of on the pool
+    bool Flush();
+    // Loads the file first, like Flush
+    size_t EntryCount();
+
+    static const uint32_t kVersion = 1;
+    static const int64_t kStaleSeconds = 7 * 24 * 3600;
+    // Entries not stored again for this long are left out of the next write
+    static const int64_t kMaxAgeSeconds = 90 * 24 * 3600;
+
+private:
+    IconDiskCache(const IconDiskCache&) = delete;
+    IconDiskCache& operator=(const IconDiskCache&) = delete;
+
+    struct Icon {
+        int width = 0;
+        int height = 0;
+        int64_t written = 0; // Unix seconds
+        // Either into the mapping or owned
+        const uint8_t* pixels = nullptr;
+        std::shared_ptr<const std::vector<uint8_t>> owned;
+        bool revalidating = false; // Reported stale this run
+    };
+
+    // Shared with the load and write-behind tasks
+    struct State {
+        std::mutex mutex;
+        std::mutex load_mutex; // Held while mapping, without mutex
+        std::string path;
+        std::atomic<bool> ready{false};
+        std::atomic<bool> load_queued{false};
+        bool dirty = false;
+        bool flush_queued = false;
+        MappedFile file; // Only touched once ready
+        std::function<void()> on_ready;
+        std::unordered_map<std::string, Icon> icons; // (large ? 'L' : 'S') + key
+    };
+
+    static void LoadState(State& state);
+    static bool FlushState(State& state);
+
+    std::shared_ptr<State> state;
+    TaskScheduler& scheduler;
+};
+
+}
@@ -0,0 +1,72 @@
+#include "IconProvider.h"
+#include <cstring>
+
+namespace core {
+
+#if defined(_WIN32)
+std::unique_ptr<IconProvider> CreateWin32IconProvider();
+#endif
+
+std::unique_ptr<IconProvider> CreateIconProvider() {
+#if defined(_WIN32)
+    return CreateWin32IconProvider();
+#else
+    return std::make_unique<StubIconProvider>();
+#endif
+}
+
+void IconBitmap::Allocate(int w, int h) {
+    width = w;
+    height = h;
+    rgba.reset(new uint8_t[ByteSize()]);
+}
+
+namespace {
+
+void FillRect(IconBitmap& bmp, int x0, int y0, int x1, int y1, uint32_t rgba) {
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            uint8_t* p = &bmp.rgba[(static_cast<size_t>(y) * bmp.width + x) * 4];
+            p[0] = static_cast<uint8_t>(rgba >> 24);
+            p[1] = static_cast<uint8_t>(rgba >> 16);
+            p[2] = static_cast<uint8_t>(rgba >> 8);
+            p[3] = static_cast<uint8_t>(rgba);
+        }
+    }
+}
+
+}
+
+void DrawPlaceholderIcon(bool is_dir, int size, IconBitmap& out) {
+    out.Allocate(size, size);
+    std::memset(out.rgba.get(), 0, out.ByteSize());
+    int u = size / 16 > 0 ? size / 16 : 1; // One "pixel" of the 16px design
+
+    if (is_dir) {
+        // Tab on top, body below
+        FillRect(out, 1 * u, 3 * u, 7 * u, 5 * u, 0xD9A93EFF);
+        FillRect(out, 1 * u, 5 * u, 15 * u, 14 * u, 0xF2C55CFF);
+    } else {
+        // Grey outlined page
+        FillRect(out, 3 * u, 1 * u, 13 * u, 15 * u, 0x8A8A8AFF);
+        FillRect(out, 4 * u, 2 * u, 12 * u, 14 * u, 0xF5F5F5FF);
+    }
+}
+
+bool StubIconProvider::LoadTypeIcon(IconId id, bool large, IconBitmap& out) {
+    DrawPlaceholderIcon(id == kIconFolder, IconSize(large), out);
+    return true;
+}
+
+bool StubIconProvider::LoadPathIcon(const std::string& path, bool large, IconBitmap& out) {
+    if (path.empty()) return false;
+    // No stat here: a name without an extension is drawn as a folder
+    size_t slash = path.find_last_of("/\\");
+    std::string_view name(path);
+    if (slash != std::string::npos) name = name.substr(slash + 1);
+    DrawPlaceholderIcon(name.empty() || InternIconType(name, false) == kIconGenericFile,
+                        IconSize(large), out);
+    return true;
+}
+
+}
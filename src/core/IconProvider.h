@@ -0,0 +1,54 @@
+#pragma once
+#include "IconType.h"
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace core {
+
+// Decoded icon: straight-alpha RGBA, rows packed top-down with no padding.
+// The buffer comes from new[] so an Fl_RGB_Image can adopt it as is.
+struct IconBitmap {
+    int width = 0;
+    int height = 0;
+    std::unique_ptr<uint8_t[]> rgba;
+
+    void Allocate(int w, int h);
+    size_t ByteSize() const { return static_cast<size_t>(width) * height * 4; }
+};
+
+// Where icon pixels come from. Only called from pool workers (see
+// IconService), so implementations may block on the shell or the disk.
+class IconProvider {
+public:
+    virtual ~IconProvider() = default;
+
+    // Generic icon for an interned type: folder, extensionless file, ".ext"
+    virtual bool LoadTypeIcon(IconId id, bool large, IconBitmap& out) = 0;
+
+    // Icon of one particular item (executables, drives, special folders)
+    virtual bool LoadPathIcon(const std::string& path, bool large, IconBitmap& out) = 0;
+
+    virtual const char* Name() const = 0;
+};
+
+// Shell icons on Windows, StubIconProvider elsewhere
+std::unique_ptr<IconProvider> CreateIconProvider();
+
+// Draws flat folder/page shapes itself; no system calls, so headless tests
+// and platforms without a shell still get something to show
+class StubIconProvider : public IconProvider {
+public:
+    bool LoadTypeIcon(IconId id, bool large, IconBitmap& out) override;
+    bool LoadPathIcon(const std::string& path, bool large, IconBitmap& out) override;
+    const char* Name() const override { return "stub"; }
+};
+
+// Placeholder art shown while the real icon loads
+void DrawPlaceholderIcon(bool is_dir, int size, IconBitmap& out);
+
+// Pixel size for small (list) and large (tab/app) icons
+inline int IconSize(bool large) { return large ? 32 : 16; }
+
+}
@@ -0,0 +1,99 @@
+#if defined(_WIN32)
+#include "IconProvider.h"
+#include "PixelConvert.h"
+#include "WideString.h"
+#include <windows.h>
+#include <shellapi.h>
+#include <algorithm>
+#include <cstring>
+
+namespace core {
+
+namespace {
+
+// Renders the icon into a top-down 32-bit DIB and swaps BGRA to RGBA
+bool HIconToBitmap(HICON hIcon, IconBitmap& out) {
+    if (!hIcon) return false;
+
+    ICONINFO iconInfo;
+    if (!GetIconInfo(hIcon, &iconInfo)) return false;
+
+    BITMAP bmp;
+    GetObject(iconInfo.hbmColor ? iconInfo.hbmColor : iconInfo.hbmMask, sizeof(BITMAP), &bmp);
+    int width = bmp.bmWidth;
+    int height = iconInfo.hbmColor ? bmp.bmHeight : bmp.bmHeight / 2; // Mono masks stack AND over XOR
+
+    HDC hDC = GetDC(NULL);
+    HDC hMemDC = CreateCompatibleDC(hDC);
+
+    BITMAPINFO bmi;
+    memset(&bmi, 0, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height; // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    void* bits = nullptr;
+    HBITMAP hBitmap = CreateDIBSection(hDC, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    bool ok = hBitmap && bits;
+    if (ok) {
+        HGDIOBJ oldObj = SelectObject(hMemDC, hBitmap);
+        DrawIconEx(hMemDC, 0, 0, hIcon, width, height, 0, NULL, DI_NORMAL);
+        GdiFlush();
+
+        // One pass straight from the DIB into the buffer the image will own
+        out.Allocate(width, height);
+        ConvertBgraToRgba(static_cast<const uint8_t*>(bits), out.rgba.get(),
+                          static_cast<size_t>(width) * height);
+        SelectObject(hMemDC, oldObj);
+    }
+
+    if (hBitmap) DeleteObject(hBitmap);
+    DeleteDC(hMemDC);
+    ReleaseDC(NULL, hDC);
+    if (iconInfo.hbmColor) DeleteObject(iconInfo.hbmColor);
+    DeleteObject(iconInfo.hbmMask);
+    return ok;
+}
+
+bool ShellIcon(const std::wstring& path, DWORD attributes, UINT flags, IconBitmap& out) {
+    SHFILEINFOW sfi = {0};
+    if (!SHGetFileInfoW(path.c_str(), attributes, &sfi, sizeof(sfi), flags | SHGFI_ICON)) return false;
+    bool ok = HIconToBitmap(sfi.hIcon, out);
+    DestroyIcon(sfi.hIcon);
+    return ok;
+}
+
+// SHGetFileInfo needs COM on the calling thread; pool workers set it up
+class Win32IconProvider : public IconProvider {
+public:
+    bool LoadTypeIcon(IconId id, bool large, IconBitmap& out) override {
+        // USEFILEATTRIBUTES answers from the registry without touching disk
+        UINT flags = SHGFI_USEFILEATTRIBUTES | (large ? SHGFI_LARGEICON : SHGFI_SMALLICON);
+        if (id == kIconFolder) {
+            return ShellIcon(L"directory", FILE_ATTRIBUTE_DIRECTORY, flags, out);
+        }
+        std::string ext = IconTypeExtension(id);
+        return ShellIcon(ToWide("dummy" + (ext.empty() ? std::string(".dat") : ext)),
+                         FILE_ATTRIBUTE_NORMAL, flags, out);
+    }
+
+    bool LoadPathIcon(const std::string& path, bool large, IconBitmap& out) override {
+        std::string lookup_path = path;
+        std::replace(lookup_path.begin(), lookup_path.end(), '/', '\\');
+        return ShellIcon(ToWide(lookup_path), 0, large ? SHGFI_LARGEICON : SHGFI_SMALLICON, out);
+    }
+
+    const char* Name() const override { return "shell"; }
+};
+
+}
+
+std::unique_ptr<IconProvider> CreateWin32IconProvider() {
+    return std::make_unique<Win32IconProvider>();
+}
+
+}
+#endif
@@ -0,0 +1,91 @@
+#include "IconService.h"
+#include "Trace.h"
+#include "Metrics.h"
+
+namespace core {
+
+IconService& IconService::Get() {
+    static IconService instance(CreateIconProvider());
+    return instance;
+}
+
+IconService::IconService(std::unique_ptr<IconProvider> provider, TaskScheduler& scheduler)
+    : state(std::make_shared<State>()), scheduler(scheduler) {
+    state->provider = std::move(provider);
+}
+
+IconService::~IconService() {
+    // Tasks still queued finish into the orphaned state and notify nobody
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->on_ready = nullptr;
+}
+
+bool IconService::RequestType(IconId id, bool large, TaskPriority priority) {
+    return Request(id, std::string(), large, priority);
+}
+
+bool IconService::RequestPath(const std::string& path, bool large, TaskPriority priority) {
+    if (path.empty()) return false;
+    return Request(kIconGenericFile, path, large, priority);
+}
+
+bool IconService::Request(IconId id, const std::string& path, bool large, TaskPriority priority) {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->in_flight.emplace(id, path, large).second) return false;
+    }
+    std::shared_ptr<State> shared = state;
+    scheduler.Submit(priority, [shared, id, path, large]() { Run(shared, id, path, large); });
+    return true;
+}
+
+void IconService::Run(const std::shared_ptr<State>& state, IconId id, const std::string& path, bool large) {
+    IconResult result;
+    result.id = id;
+    result.path = path;
+    result.large = large;
+    TRACE_SPAN_DETAIL("LoadIcon", "icon", path.empty() ? IconTypeExtension(id) : path);
+    static Histogram& load_time = Metrics::Get().GetHistogram("icons.shell_time");
+    ScopedTimer timer(load_time);
+    // Providers are stateless apart from COM, so lookups run unlocked
+    if (result.path.empty()) {
+        result.ok = state->provider->LoadTypeIcon(result.id, result.large, result.bitmap);
+    } else {
+        result.ok = state->provider->LoadPathIcon(result.path, result.large, result.bitmap);
+    }
+
+    std::function<void()> notify;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->in_flight.erase(std::make_tuple(result.id, result.path, result.large));
+        // Only the first result of a batch wakes the UI; the drain takes them all
+        if (state->completed.empty()) notify = state->on_ready;
+        state->completed.push_back(std::move(result));
+    }
+    if (notify) notify();
+}
+
+void IconService::SetReadyCallback(std::function<void()> cb) {
+    bool pending;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->on_ready = cb;
+        pending = !state->completed.empty();
+    }
+    // Results that landed before anyone listened
+    if (pending && cb) cb();
+}
+
+std::vector<IconResult> IconService::TakeCompleted() {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    std::vector<IconResult> out;
+    out.swap(state->completed);
+    return out;
+}
+
+size_t IconService::PendingCount() {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->in_flight.size();
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "IconProvider.h"
+#include "TaskScheduler.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace core {
+
+// A finished lookup. Type requests leave path empty.
+struct IconResult {
+    IconId id = kIconGenericFile;
+    std::string path;
+    bool large = false;
+    bool ok = false;
+    IconBitmap bitmap;
+};
+
+// Runs IconProvider lookups on the TaskScheduler so the UI thread never
+// waits on the shell. Identical requests in flight are merged; results
+// queue up until the UI drains them with TakeCompleted().
+class IconService {
+public:
+    static IconService& Get();
+
+    explicit IconService(std::unique_ptr<IconProvider> provider,
+                         TaskScheduler& scheduler = TaskScheduler::Get());
+    ~IconService();
+
+    // Return false if the same request is already queued or running
+    bool RequestType(IconId id, bool large, TaskPriority priority = TaskPriority::ActiveTab);
+    bool RequestPath(const std::string& path, bool large, TaskPriority priority = TaskPriority::Prefetch);
+
+    // Called on a worker whenever results were queued; keep it cheap
+    // (typically an Fl::awake)
+    void SetReadyCallback(std::function<void()> cb);
+
+    std::vector<IconResult> TakeCompleted();
+    size_t PendingCount();
+
+private:
+    IconService(const IconService&) = delete;
+    IconService& operator=(const IconService&) = delete;
+
+    // Shared with queued tasks so they stay valid if the service goes first
+    struct State {
+        std::mutex mutex;
+        std::shared_ptr<IconProvider> provider;
+        std::set<std::tuple<IconId, std::string, bool>> in_flight;
+        std::vector<IconResult> completed;
+        std::function<void()> on_ready;
+    };
+
+    bool Request(IconId id, const std::string& path, bool large, TaskPriority priority);
+    static void Run(const std::shared_ptr<State>& state, IconId id, const std::string& path, bool large);
+
+    std::shared_ptr<State> state;
+    TaskScheduler& scheduler;
+};
+
+}
@@ -0,0 +1,76 @@
+#include "IconType.h"
+#include "ListingSort.h"
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+namespace core {
+
+namespace {
+
+// Longer "extensions" are almost always parts of a name, not a type
+const size_t kMaxExtensionLength = 15;
+
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, IconId> ids;
+    std::vector<std::string> extensions{"", ""}; // kIconFolder, kIconGenericFile
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+}
+
+IconId InternIconType(std::string_view name, bool is_dir) {
+    if (is_dir) return kIconFolder;
+
+    std::string_view ext = FileExtension(name);
+    if (ext.empty() || ext.size() > kMaxExtensionLength) return kIconGenericFile;
+
+    // At most 15 chars fits the small-string buffer: no allocation here
+    char folded[kMaxExtensionLength];
+    size_t n = 0;
+    for (char c : ext) {
+        folded[n++] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    std::string key(folded, n);
+
+    thread_local std::unordered_map<std::string, IconId> cache;
+    auto hit = cache.find(key);
+    if (hit != cache.end()) return hit->second;
+
+    Registry& registry = GetRegistry();
+    IconId id;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto it = registry.ids.find(key);
+        if (it != registry.ids.end()) {
+            id = it->second;
+        } else if (registry.extensions.size() >= kMaxIconTypes) {
+            id = kIconGenericFile;
+        } else {
+            id = static_cast<IconId>(registry.extensions.size());
+            registry.extensions.push_back("." + key);
+            registry.ids.emplace(key, id);
+        }
+    }
+    cache.emplace(std::move(key), id);
+    return id;
+}
+
+std::string IconTypeExtension(IconId id) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return id < registry.extensions.size() ? registry.extensions[id] : std::string();
+}
+
+size_t IconTypeCount() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.extensions.size();
+}
+
+}
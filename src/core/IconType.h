@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace core {
+
+// Small dense id for "what generic icon does this entry get": one per
+// folder, extensionless file, and lower-cased extension seen so far.
+// Resolved once per entry at load time, so drawing never parses names.
+using IconId = uint16_t;
+
+const IconId kIconFolder = 0;
+const IconId kIconGenericFile = 1; // No extension, or one we do not track
+const size_t kMaxIconTypes = 1 << 16;
+
+// Thread-safe; repeated lookups are served from a per-thread cache
+IconId InternIconType(std::string_view name, bool is_dir);
+
+// ".txt" style extension for an id ("" for folder and generic file)
+std::string IconTypeExtension(IconId id);
+
+size_t IconTypeCount();
+
+}
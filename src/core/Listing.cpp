@@ -0,0 +1,220 @@
+#include "Listing.h"
+#include "DirectoryEnumerator.h"
+#include "FileSystem.h"
+#include "SortKey.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace core {
+
+void Listing::clear() {
+    names.clear();
+    name_offsets.clear();
+    name_lengths.clear();
+    keys.clear();
+    key_offsets.clear();
+    key_lengths.clear();
+    sizes.clear();
+    mtimes.clear();
+    attributes.clear();
+    flags.clear();
+    icons.clear();
+}
+
+void Listing::reserve(size_t entries, size_t name_bytes) {
+    names.reserve(name_bytes);
+    name_offsets.reserve(entries);
+    name_lengths.reserve(entries);
+    keys.reserve(name_bytes);
+    key_offsets.reserve(entries);
+    key_lengths.reserve(entries);
+    sizes.reserve(entries);
+    mtimes.reserve(entries);
+    attributes.reserve(entries);
+    flags.reserve(entries);
+    icons.reserve(entries);
+}
+
+void Listing::Append(std::string_view name, bool is_dir, uint64_t size, bool size_known,
+                     int64_t mtime, uint8_t attrs) {
+    // NTFS and ext4 cap names at 255 units; UTF-8 can still exceed that in bytes
+    name = name.substr(0, std::min<size_t>(name.size(), UINT16_MAX));
+    size_t key_start = keys.size();
+    AppendCollationKey(name, keys);
+    PushEntry(name, key_start, is_dir, size, size_known, mtime, attrs, InternIconType(name, is_dir));
+}
+
+void Listing::Append(std::string_view name, std::string_view key, IconId icon, bool is_dir, uint64_t size,
+                     bool size_known, int64_t mtime, uint8_t attrs) {
+    size_t key_start = keys.size();
+    keys.append(key);
+    PushEntry(name.substr(0, std::min<size_t>(name.size(), UINT16_MAX)), key_start, is_dir, size, size_known,
+              mtime, attrs, icon);
+}
+
+void Listing::Append(const DirEntryInfo& info) {
+    Append(info.name, info.is_dir, info.size, info.size_known, info.mtime, static_cast<uint8_t>(info.attributes));
+}
+
+void Listing::Append(const Listing& other, size_t first, size_t last) {
+    // Keys are copied, not rebuilt
+    for (size_t i = first; i < last; ++i) {
+        size_t key_start = keys.size();
+        keys.append(other.Key(i));
+        PushEntry(other.Name(i), key_start, other.IsDir(i), other.Size(i), other.SizeKnown(i),
+                  other.MTime(i), other.Attributes(i), other.Icon(i));
+    }
+}
+
+void Listing::UpdateFrom(size_t i, const Listing& other, size_t j) {
+    sizes[i] = other.sizes[j];
+    mtimes[i] = other.mtimes[j];
+    attributes[i] = other.attributes[j];
+    flags[i] = other.flags[j];
+    icons[i] = other.icons[j]; // A name can turn from file into folder
+}
+
+std::vector<uint32_t> Listing::Erase(const std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap(size(), 0);
+    for (uint32_t i : indices) remap[i] = kNoIndex;
+
+    // Rebuild so the arenas do not keep the dropped names
+    Listing kept(parent);
+    kept.reserve(size() - indices.size(), names.size());
+    for (size_t i = 0; i < size(); ++i) {
+        if (remap[i] == kNoIndex) continue;
+        remap[i] = static_cast<uint32_t>(kept.size());
+        kept.Append(*this, i, i + 1);
+    }
+    *this = std::move(kept);
+    return remap;
+}
+
+// The key for this entry has already been appended at keys[key_start..]
+void Listing::PushEntry(std::string_view name, size_t key_start, bool is_dir, uint64_t size,
+                        bool size_known, int64_t mtime, uint8_t attrs, IconId icon) {
+    name_offsets.push_back(static_cast<uint32_t>(names.size()));
+    name_lengths.push_back(static_cast<uint16_t>(name.size()));
+    names.insert(names.end(), name.data(), name.data() + name.size());
+    names.push_back('\0');
+
+    key_offsets.push_back(static_cast<uint32_t>(key_start));
+    key_lengths.push_back(static_cast<uint16_t>(std::min<size_t>(keys.size() - key_start, UINT16_MAX)));
+
+    sizes.push_back(size);
+    mtimes.push_back(mtime);
+    attributes.push_back(attrs);
+    flags.push_back(static_cast<uint8_t>((is_dir ? kEntryDir : 0) | (size_known ? kEntrySizeKnown : 0)));
+    icons.push_back(icon);
+}
+
+std::string Listing::Path(size_t i) const {
+    return JoinPath(parent, std::string(Name(i)));
+}
+
+void Listing::Permute(const std::vector<uint32_t>& order) {
+    // Names keep their arena slots; only the per-entry arrays move
+    std::vector<uint32_t> new_offsets(order.size());
+    std::vector<uint16_t> new_lengths(order.size());
+    std::vector<uint32_t> new_key_offsets(order.size());
+    std::vector<uint16_t> new_key_lengths(order.size());
+    std::vector<uint64_t> new_sizes(order.size());
+    std::vector<int64_t> new_mtimes(order.size());
+    std::vector<uint8_t> new_attributes(order.size());
+    std::vector<uint8_t> new_flags(order.size());
+    std::vector<IconId> new_icons(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        uint32_t src = order[i];
+        new_offsets[i] = name_offsets[src];
+        new_lengths[i] = name_lengths[src];
+        new_key_offsets[i] = key_offsets[src];
+        new_key_lengths[i] = key_lengths[src];
+        new_sizes[i] = sizes[src];
+        new_mtimes[i] = mtimes[src];
+        new_attributes[i] = attributes[src];
+        new_flags[i] = flags[src];
+        new_icons[i] = icons[src];
+    }
+    name_offsets.swap(new_offsets);
+    name_lengths.swap(new_lengths);
+    key_offsets.swap(new_key_offsets);
+    key_lengths.swap(new_key_lengths);
+    sizes.swap(new_sizes);
+    mtimes.swap(new_mtimes);
+    attributes.swap(new_attributes);
+    flags.swap(new_flags);
+    icons.swap(new_icons);
+}
+
+size_t Listing::MemoryUsage() const {
+    return parent.capacity() + names.capacity() +
+        name_offsets.capacity() * sizeof(uint32_t) +
+        name_lengths.capacity() * sizeof(uint16_t) +
+        keys.capacity() +
+        key_offsets.capacity() * sizeof(uint32_t) +
+        key_lengths.capacity() * sizeof(uint16_t) +
+        sizes.capacity() * sizeof(uint64_t) +
+        mtimes.capacity() * sizeof(int64_t) +
+        attributes.capacity() +
+        flags.capacity() +
+        icons.capacity() * sizeof(IconId);
+}
+
+static bool SameMetadata(const Listing& a, size_t i, const Listing& b, size_t j) {
+    return a.Size(i) == b.Size(j) && a.MTime(i) == b.MTime(j) && a.Attributes(i) == b.Attributes(j) &&
+        a.IsDir(i) == b.IsDir(j) && a.SizeKnown(i) == b.SizeKnown(j);
+}
+
+ListingDiff DiffListings(const Listing& old, const Listing& fresh) {
+    ListingDiff diff;
+    std::unordered_map<std::string_view, uint32_t> by_name;
+    by_name.reserve(old.size());
+    for (size_t i = 0; i < old.size(); ++i) by_name.emplace(old.Name(i), static_cast<uint32_t>(i));
+
+    std::vector<uint8_t> seen(old.size(), 0);
+    for (size_t j = 0; j < fresh.size(); ++j) {
+        auto it = by_name.find(fresh.Name(j));
+        if (it == by_name.end()) {
+            diff.added.push_back(static_cast<uint32_t>(j));
+            continue;
+        }
+        uint32_t i = it->second;
+        seen[i] = 1;
+        if (!SameMetadata(old, i, fresh, j)) {
+            diff.changed.emplace_back(i, static_cast<uint32_t>(j));
+        }
+    }
+    for (size_t i = 0; i < old.size(); ++i) {
+        if (!seen[i]) diff.removed.push_back(static_cast<uint32_t>(i));
+    }
+    return diff;
+}
+
+ListingDiff DiffListings(const Listing& old, const Listing& fresh, const std::vector<std::string>& names) {
+    ListingDiff diff;
+    // name -> index in fresh, kNoIndex if the name is gone
+    std::unordered_map<std::string_view, uint32_t> touched;
+    touched.reserve(names.size());
+    for (const auto& name : names) touched.emplace(name, kNoIndex);
+    for (size_t j = 0; j < fresh.size(); ++j) touched[fresh.Name(j)] = static_cast<uint32_t>(j);
+
+    // One pass over old; matched names are erased so the rest are additions
+    for (size_t i = 0; i < old.size() && !touched.empty(); ++i) {
+        auto it = touched.find(old.Name(i));
+        if (it == touched.end()) continue;
+        uint32_t j = it->second;
+        if (j == kNoIndex) {
+            diff.removed.push_back(static_cast<uint32_t>(i));
+        } else if (!SameMetadata(old, i, fresh, j)) {
+            diff.changed.emplace_back(static_cast<uint32_t>(i), j);
+        }
+        touched.erase(it);
+    }
+    for (const auto& entry : touched) {
+        if (entry.second != kNoIndex) diff.added.push_back(entry.second);
+    }
+    std::sort(diff.added.begin(), diff.added.end());
+    return diff;
+}
+
+}
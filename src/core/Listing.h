@@ -0,0 +1,106 @@
+#pragma once
+#include "IconType.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace core {
+
+struct DirEntryInfo;
+
+const uint32_t kNoIndex = UINT32_MAX;
+
+// Per-entry flag bits
+enum ListingFlag : uint8_t {
+    kEntryDir       = 1 << 0,
+    kEntrySizeKnown = 1 << 1,
+};
+
+// Struct-of-arrays storage for one directory listing.
+// Names live back to back in a single arena (NUL-terminated so they can be
+// drawn directly), numeric fields sit in parallel arrays, and full paths are
+// derived from the parent on demand instead of being stored per entry.
+// Each entry also carries its collation key (see SortKey.h), computed once
+// on append so sorting never folds case per comparison.
+class Listing {
+public:
+    Listing() = default;
+    explicit Listing(std::string parent) : parent(std::move(parent)) {}
+
+    const std::string& Parent() const { return parent; }
+    void SetParent(std::string path) { parent = std::move(path); }
+
+    size_t size() const { return flags.size(); }
+    bool empty() const { return flags.empty(); }
+    void clear();
+    void reserve(size_t entries, size_t name_bytes);
+
+    void Append(std::string_view name, bool is_dir, uint64_t size, bool size_known,
+                int64_t mtime = 0, uint8_t attributes = 0);
+    void Append(const DirEntryInfo& info);
+    // Takes a key and icon made for this name earlier in the run (see ListingSpill.h)
+    void Append(std::string_view name, std::string_view key, IconId icon, bool is_dir, uint64_t size,
+                bool size_known, int64_t mtime, uint8_t attributes);
+    // Appends entries [first, last) of other (used to publish streamed batches)
+    void Append(const Listing& other, size_t first, size_t last);
+
+    // Copies size, mtime, attributes and flags of other[j] onto entry i
+    void UpdateFrom(size_t i, const Listing& other, size_t j);
+    // Drops the given entries (any order) and returns the old -> new index
+    // map, with kNoIndex for dropped entries
+    std::vector<uint32_t> Erase(const std::vector<uint32_t>& indices);
+
+    std::string_view Name(size_t i) const { return std::string_view(&names[name_offsets[i]], name_lengths[i]); }
+    std::string_view Key(size_t i) const { return std::string_view(&keys[key_offsets[i]], key_lengths[i]); }
+    const char* NameCStr(size_t i) const { return &names[name_offsets[i]]; }
+    bool IsDir(size_t i) const { return (flags[i] & kEntryDir) != 0; }
+    bool SizeKnown(size_t i) const { return (flags[i] & kEntrySizeKnown) != 0; }
+    uint64_t Size(size_t i) const { return sizes[i]; }
+    int64_t MTime(size_t i) const { return mtimes[i]; }       // Unix seconds, 0 if unknown
+    uint8_t Attributes(size_t i) const { return attributes[i]; } // EntryAttribute bits
+    IconId Icon(size_t i) const { return icons[i]; }             // Resolved on append
+    std::string Path(size_t i) const;
+
+    // Rearranges entries so that new position i holds old entry order[i]
+    void Permute(const std::vector<uint32_t>& order);
+
+    // Approximate heap bytes held by the listing
+    size_t MemoryUsage() const;
+
+private:
+    void PushEntry(std::string_view name, size_t key_start, bool is_dir, uint64_t size,
+                   bool size_known, int64_t mtime, uint8_t attrs, IconId icon);
+
+    std::string parent;
+    std::vector<char> names;
+    std::vector<uint32_t> name_offsets;
+    std::vector<uint16_t> name_lengths;
+    std::string keys;
+    std::vector<uint32_t> key_offsets;
+    std::vector<uint16_t> key_lengths;
+    std::vector<uint64_t> sizes;
+    std::vector<int64_t> mtimes;
+    std::vector<uint8_t> attributes;
+    std::vector<uint8_t> flags;
+    std::vector<IconId> icons;
+};
+
+// Entry-level differences between two listings of the same directory,
+// matched by name
+struct ListingDiff {
+    std::vector<uint32_t> removed;                       // Indices into old
+    std::vector<uint32_t> added;                         // Indices into fresh
+    std::vector<std::pair<uint32_t, uint32_t>> changed;  // (old, fresh) with new metadata
+
+    bool empty() const { return removed.empty() && added.empty() && changed.empty(); }
+};
+
+ListingDiff DiffListings(const Listing& old, const Listing& fresh);
+// Same, restricted to names: fresh holds the current state of those of them
+// that still exist, anything else in old is assumed unchanged
+ListingDiff DiffListings(const Listing& old, const Listing& fresh, const std::vector<std::string>& names);
+
+}
@@ -0,0 +1,106 @@
+#include "ListingCache.h"
+#include <filesystem>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace core {
+
+static const size_t kDefaultBudget = 256 * 1024 * 1024;
+
+ListingCache& ListingCache::Get() {
+    static ListingCache instance(kDefaultBudget);
+    return instance;
+}
+
+ListingCache::ListingCache(size_t budget_bytes) : budget(budget_bytes) {}
+
+std::string ListingCache::CanonicalKey(const std::string& path) {
+    std::string key = path;
+    std::replace(key.begin(), key.end(), '\\', '/');
+    // Keep "/" and "C:/" as they are
+    while (key.size() > 1 && key.back() == '/' && !(key.size() == 3 && key[1] == ':')) {
+        key.pop_back();
+    }
+    if (key.size() == 2 && key[1] == ':') key += '/';
+#ifdef _WIN32
+    for (auto& c : key) {
+        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+    }
+#endif
+    return key;
+}
+
+bool ListingCache::Lookup(const std::string& path, Entry& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(CanonicalKey(path));
+    if (it == index.end()) return false;
+    lru.splice(lru.begin(), lru, it->second);
+    out = it->second->entry;
+    return true;
+}
+
+void ListingCache::Store(const std::string& path, Entry entry) {
+    if (!entry.listing) return;
+    // Counted in full even while a tab shares it; the tab lets go eventually
+    size_t bytes = entry.listing->MemoryUsage() + (entry.order ? entry.order->capacity() * sizeof(uint32_t) : 0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string key = CanonicalKey(path);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        used -= it->second->bytes;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+    // A listing bigger than the whole budget would only evict everything else
+    if (bytes > budget) return;
+
+    lru.push_front({key, std::move(entry), bytes});
+    index[key] = lru.begin();
+    used += bytes;
+    EvictLocked();
+}
+
+void ListingCache::Invalidate(const std::string& path, const Listing* listing) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(CanonicalKey(path));
+    if (it == index.end()) return;
+    if (listing && it->second->entry.listing.get() != listing) return;
+    used -= it->second->bytes;
+    lru.erase(it->second);
+    index.erase(it);
+}
+
+void ListingCache::SetBudget(size_t budget_bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = budget_bytes;
+    EvictLocked();
+}
+
+size_t ListingCache::MemoryUsage() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+size_t ListingCache::EntryCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+void ListingCache::EvictLocked() {
+    while (used > budget && !lru.empty()) {
+        used -= lru.back().bytes;
+        index.erase(lru.back().key);
+        lru.pop_back();
+    }
+}
+
+int64_t DirectoryChangeStamp(const std::string& path) {
+    std::error_code ec;
+    auto t = fs::last_write_time(path, ec);
+    if (ec) return 0;
+    return (int64_t)t.time_since_epoch().count();
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "Listing.h"
+#include "ListingSort.h"
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+namespace core {
+
+// Process-wide LRU of recently loaded directory listings, bounded by a
+// memory budget. Revisits paint from the cached listing immediately and
+// are revalidated in the background against the directory's change stamp.
+class ListingCache {
+public:
+    // Shares its listing and order with the tab that published them
+    struct Entry {
+        std::shared_ptr<const Listing> listing;
+        std::shared_ptr<const std::vector<uint32_t>> order; // Display order for spec
+        SortSpec spec;
+        int64_t stamp = 0;           // DirectoryChangeStamp when enumerated
+    };
+
+    static ListingCache& Get();
+
+    explicit ListingCache(size_t budget_bytes);
+
+    // Returns false on a miss. A hit becomes most recently used.
+    bool Lookup(const std::string& path, Entry& out);
+    void Store(const std::string& path, Entry entry);
+    // With listing set, only drops the entry if it still holds that one
+    void Invalidate(const std::string& path, const Listing* listing = nullptr);
+
+    void SetBudget(size_t budget_bytes);
+    size_t MemoryUsage();
+    size_t EntryCount();
+
+    // Cache key: '/' separators, no trailing separator except at a root,
+    // and case-insensitive on Windows
+    static std::string CanonicalKey(const std::string& path);
+
+private:
+    struct Node {
+        std::string key;
+        Entry entry;
+        size_t bytes;
+    };
+
+    void EvictLocked();
+
+    std::list<Node> lru; // Front is most recently used
+    std::unordered_map<std::string, std::list<Node>::iterator> index;
+    std::mutex mutex;
+    size_t budget;
+    size_t used = 0;
+};
+
+// Cheap "did this directory change" probe: the directory's own last write
+// time, which moves when entries are created, deleted or renamed.
+// Returns 0 if the directory cannot be stat'ed.
+int64_t DirectoryChangeStamp(const std::string& path);
+
+}
@@ -0,0 +1,76 @@
+#include "ListingCodec.h"
+#include <algorithm>
+
+namespace core {
+
+namespace {
+
+struct EntryHeader {
+    uint64_t size;
+    int64_t mtime;
+    uint16_t name_length;
+    uint16_t key_length;
+    IconId icon;
+    uint8_t flags; // ListingFlag bits
+    uint8_t attributes;
+};
+
+}
+
+void EncodeListingEntries(const Listing& listing, std::string& out) {
+    out.reserve(out.size() + listing.size() * (sizeof(EntryHeader) + 48));
+    for (size_t i = 0; i < listing.size(); ++i) {
+        std::string_view name = listing.Name(i);
+        std::string_view key = listing.Key(i);
+        EntryHeader entry = {}; // No stray padding bytes in the file
+        entry.size = listing.Size(i);
+        entry.mtime = listing.MTime(i);
+        entry.name_length = static_cast<uint16_t>(name.size());
+        entry.key_length = static_cast<uint16_t>(key.size());
+        entry.icon = listing.Icon(i);
+        entry.flags = static_cast<uint8_t>((listing.IsDir(i) ? kEntryDir : 0) |
+                                           (listing.SizeKnown(i) ? kEntrySizeKnown : 0));
+        entry.attributes = listing.Attributes(i);
+        AppendRaw(out, entry);
+        out.append(name.data(), name.size());
+        out.append(key.data(), key.size());
+    }
+}
+
+bool DecodeListingEntries(ByteReader& in, uint32_t count, bool keep_icons, Listing& out) {
+    // A damaged count must not size the reservation
+    if (count > in.Left() / sizeof(EntryHeader)) return false;
+    size_t icon_count = IconTypeCount();
+    out.reserve(out.size() + count, std::min<size_t>(in.Left(), count * size_t(24)));
+    for (uint32_t i = 0; i < count; ++i) {
+        EntryHeader entry;
+        const char* name;
+        const char* key;
+        if (!in.Get(entry) || !in.Bytes(entry.name_length, name) || !in.Bytes(entry.key_length, key)) return false;
+        std::string_view name_view(name, entry.name_length);
+        bool is_dir = (entry.flags & kEntryDir) != 0;
+        if (keep_icons && entry.icon >= icon_count) return false;
+        IconId icon = keep_icons ? entry.icon : InternIconType(name_view, is_dir);
+        out.Append(name_view, std::string_view(key, entry.key_length), icon, is_dir, entry.size,
+                   (entry.flags & kEntrySizeKnown) != 0, entry.mtime, entry.attributes);
+    }
+    return true;
+}
+
+void EncodeListingOrder(const std::vector<uint32_t>& order, std::string& out) {
+    out.append(reinterpret_cast<const char*>(order.data()), order.size() * sizeof(uint32_t));
+}
+
+bool DecodeListingOrder(ByteReader& in, uint32_t count, std::vector<uint32_t>& out) {
+    if (in.Left() / sizeof(uint32_t) < count) return false;
+    out.resize(count);
+    std::vector<uint8_t> seen(count, 0);
+    for (uint32_t& index : out) {
+        in.Get(index);
+        if (index >= count || seen[index]) return false; // Not a permutation
+        seen[index] = 1;
+    }
+    return true;
+}
+
+}
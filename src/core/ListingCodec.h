@@ -0,0 +1,51 @@
+#pragma once
+#include "Listing.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace core {
+
+// Binary form of listing entries shared by the session file and tab spills.
+// Each entry is a fixed header followed by its name and collation key, so
+// reading one back does no per-name folding. Host byte order and layout.
+
+template <typename T>
+void AppendRaw(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Reads sequentially from a mapping; every read checks what is left
+struct ByteReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    size_t Left() const { return static_cast<size_t>(end - p); }
+    template <typename T>
+    bool Get(T& value) {
+        if (Left() < sizeof(value)) return false;
+        std::memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        return true;
+    }
+    bool Bytes(size_t n, const char*& out) {
+        if (Left() < n) return false;
+        out = reinterpret_cast<const char*>(p);
+        p += n;
+        return true;
+    }
+};
+
+void EncodeListingEntries(const Listing& listing, std::string& out);
+// Appends count entries to out. Icon ids only mean something in the run
+// that wrote them: keep_icons takes them as written, otherwise every name
+// is interned again. False if the data is truncated or an id is unknown.
+bool DecodeListingEntries(ByteReader& in, uint32_t count, bool keep_icons, Listing& out);
+
+void EncodeListingOrder(const std::vector<uint32_t>& order, std::string& out);
+// False unless the next count indices are a permutation of [0, count)
+bool DecodeListingOrder(ByteReader& in, uint32_t count, std::vector<uint32_t>& out);
+
+}
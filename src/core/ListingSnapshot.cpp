@@ -0,0 +1,47 @@
+#include "ListingSnapshot.h"
+#include <algorithm>
+
+namespace core {
+
+size_t ListingSnapshot::size() const {
+    if (order) return order->size();
+    return part_ends.empty() ? 0 : part_ends.back();
+}
+
+const Listing& ListingSnapshot::Row(size_t row, size_t& index) const {
+    if (order) {
+        index = (*order)[row];
+        return *parts[0];
+    }
+    // Few parts (one per publish interval), so a binary search is plenty
+    size_t p = std::upper_bound(part_ends.begin(), part_ends.end(), row) - part_ends.begin();
+    index = row - (p == 0 ? 0 : part_ends[p - 1]);
+    return *parts[p];
+}
+
+size_t ListingSnapshot::MemoryUsage() const {
+    size_t bytes = order ? order->capacity() * sizeof(uint32_t) : 0;
+    for (const auto& part : parts) bytes += part->MemoryUsage();
+    return bytes;
+}
+
+std::shared_ptr<const ListingSnapshot> ListingSnapshot::Make(std::shared_ptr<const Listing> files,
+                                                             std::shared_ptr<const std::vector<uint32_t>> order,
+                                                             SortSpec spec, uint64_t version) {
+    auto snapshot = std::make_shared<ListingSnapshot>();
+    snapshot->part_ends.push_back(files->size());
+    snapshot->parts.push_back(std::move(files));
+    snapshot->order = std::move(order);
+    snapshot->spec = spec;
+    snapshot->version = version;
+    return snapshot;
+}
+
+std::shared_ptr<const ListingSnapshot> ListingSnapshot::WithPart(std::shared_ptr<const Listing> part) const {
+    auto snapshot = std::make_shared<ListingSnapshot>(*this);
+    snapshot->part_ends.push_back((part_ends.empty() ? 0 : part_ends.back()) + part->size());
+    snapshot->parts.push_back(std::move(part));
+    return snapshot;
+}
+
+}
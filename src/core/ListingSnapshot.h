@@ -0,0 +1,42 @@
+#pragma once
+#include "Listing.h"
+#include "ListingSort.h"
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace core {
+
+// Immutable state of a tab's listing as the UI sees it. A published snapshot
+// is never modified: writers build a new one, sharing whatever did not
+// change, and swap the pointer (see TabContext::Publish). Readers hold one
+// reference per frame and draw without taking any lock.
+struct ListingSnapshot {
+    // Streamed batches in arrival order; a single part once loaded
+    std::vector<std::shared_ptr<const Listing>> parts;
+    std::vector<size_t> part_ends; // Running entry count after each part
+    // Display order over parts[0]; null while rows show in arrival order
+    std::shared_ptr<const std::vector<uint32_t>> order;
+    SortSpec spec; // What order is sorted by
+    // Bumped whenever existing rows change meaning (cleared, re-sorted,
+    // patched); appending a streamed batch leaves it alone
+    uint64_t version = 0;
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    // Listing and entry index behind a display row (row < size())
+    const Listing& Row(size_t row, size_t& index) const;
+    // The listing when it is held in one piece, else null
+    const Listing* Single() const { return parts.size() == 1 ? parts[0].get() : nullptr; }
+    // Approximate heap bytes of the parts and order (shared or not)
+    size_t MemoryUsage() const;
+
+    static std::shared_ptr<const ListingSnapshot> Make(std::shared_ptr<const Listing> files,
+                                                       std::shared_ptr<const std::vector<uint32_t>> order,
+                                                       SortSpec spec, uint64_t version);
+    // Copy of this snapshot with one more streamed part (pointers only)
+    std::shared_ptr<const ListingSnapshot> WithPart(std::shared_ptr<const Listing> part) const;
+};
+
+}
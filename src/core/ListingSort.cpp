@@ -0,0 +1,322 @@
+#include "ListingSort.h"
+#include "SortKey.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+namespace core {
+
+namespace {
+
+// Below this many entries std::sort on keys beats the radix passes
+const size_t kRadixThreshold = 1 << 16;
+// MSD buckets smaller than this finish with a comparison sort
+const size_t kRadixCutoff = 64;
+// Large enough to be worth handing top-level buckets to pool workers
+const size_t kParallelThreshold = 1 << 18;
+
+// Identical keys ("file01" vs "file1", "A" vs "a") fall back to raw bytes,
+// then to enumeration order, so the result is deterministic
+bool TieLess(const Listing& files, uint32_t a, uint32_t b) {
+    int c = files.Name(a).compare(files.Name(b));
+    if (c != 0) return c < 0;
+    return a < b;
+}
+
+struct NameLess {
+    const Listing& files;
+    bool operator()(uint32_t a, uint32_t b) const {
+        int c = CompareKeys(files.Key(a), files.Key(b));
+        if (c != 0) return c < 0;
+        return TieLess(files, a, b);
+    }
+};
+
+// Compares keys from byte `depth` on; earlier bytes are known equal
+struct SuffixLess {
+    const Listing& files;
+    size_t depth;
+    bool operator()(uint32_t a, uint32_t b) const {
+        int c = CompareKeys(files.Key(a).substr(depth), files.Key(b).substr(depth));
+        if (c != 0) return c < 0;
+        return TieLess(files, a, b);
+    }
+};
+
+struct TieOnly {
+    const Listing& files;
+    bool operator()(uint32_t a, uint32_t b) const { return TieLess(files, a, b); }
+};
+
+// Bucket 0 holds keys that end at depth, 1..256 the next byte + 1
+inline size_t BucketOf(const Listing& files, uint32_t i, size_t depth) {
+    std::string_view key = files.Key(i);
+    return depth < key.size() ? (size_t)(unsigned char)key[depth] + 1 : 0;
+}
+
+// Distributes [first, last) by the key byte at depth and fills bucket bounds
+void RadixPass(const Listing& files, uint32_t* first, uint32_t* last, size_t depth,
+               std::vector<uint32_t>& scratch, size_t bounds[258]) {
+    size_t counts[257] = {0};
+    for (uint32_t* it = first; it != last; ++it) counts[BucketOf(files, *it, depth)]++;
+
+    bounds[0] = 0;
+    for (int b = 0; b < 257; ++b) bounds[b + 1] = bounds[b] + counts[b];
+
+    size_t n = last - first;
+    scratch.resize(n);
+    size_t next[257];
+    std::copy(bounds, bounds + 257, next);
+    for (uint32_t* it = first; it != last; ++it) scratch[next[BucketOf(files, *it, depth)]++] = *it;
+    std::copy(scratch.begin(), scratch.begin() + n, first);
+}
+
+void MsdRadixSort(const Listing& files, uint32_t* first, uint32_t* last, size_t depth,
+                  std::vector<uint32_t>& scratch) {
+    if ((size_t)(last - first) < kRadixCutoff) {
+        std::sort(first, last, SuffixLess{files, depth});
+        return;
+    }
+
+    size_t bounds[258];
+    RadixPass(files, first, last, depth, scratch, bounds);
+
+    // Keys that ended here are all equal
+    std::sort(first + bounds[0], first + bounds[1], TieOnly{files});
+    for (int b = 1; b < 257; ++b) {
+        if (bounds[b + 1] - bounds[b] > 1) {
+            MsdRadixSort(files, first + bounds[b], first + bounds[b + 1], depth + 1, scratch);
+        }
+    }
+}
+
+// Shared with helper tasks; stays alive if a helper starts after the sort
+struct ParallelBuckets {
+    const Listing* files = nullptr;
+    uint32_t* base = nullptr;
+    size_t bounds[258];
+    std::atomic<int> next{1};
+    std::atomic<int> in_flight{0};
+    std::mutex mutex;
+    std::condition_variable done;
+
+    void Drain() {
+        in_flight++;
+        std::vector<uint32_t> scratch;
+        int b;
+        while ((b = next++) < 257) {
+            if (bounds[b + 1] - bounds[b] > 1) {
+                MsdRadixSort(*files, base + bounds[b], base + bounds[b + 1], 1, scratch);
+            }
+        }
+        if (--in_flight == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_all();
+        }
+    }
+};
+
+// Top-level buckets are independent, so pool workers that happen to be free
+// sort some of them while the calling thread works through the rest. The
+// caller only waits for helpers that actually claimed a bucket.
+void ParallelMsdRadixSort(const Listing& files, uint32_t* first, uint32_t* last) {
+    auto state = std::make_shared<ParallelBuckets>();
+    state->files = &files;
+    state->base = first;
+
+    std::vector<uint32_t> scratch;
+    RadixPass(files, first, last, 0, scratch, state->bounds);
+    std::sort(first + state->bounds[0], first + state->bounds[1], TieOnly{files});
+
+    size_t helpers = TaskScheduler::Get().WorkerCount() - 1;
+    for (size_t h = 0; h < helpers; ++h) {
+        TaskScheduler::Get().Submit(TaskPriority::Prefetch, [state]() {
+            if (state->next.load() < 257) state->Drain();
+        });
+    }
+    state->Drain();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->in_flight.load() == 0; });
+}
+
+// Numeric keys (size, mtime) read straight from the parallel arrays
+template <typename Key>
+struct KeyLess {
+    const Listing& files;
+    Key key;
+    bool operator()(uint32_t a, uint32_t b) const {
+        auto ka = key(files, a);
+        auto kb = key(files, b);
+        if (ka != kb) return ka < kb;
+        return NameLess{files}(a, b);
+    }
+};
+
+struct SizeKey {
+    uint64_t operator()(const Listing& files, uint32_t i) const { return files.Size(i); }
+};
+
+struct DateKey {
+    int64_t operator()(const Listing& files, uint32_t i) const { return files.MTime(i); }
+};
+
+// Extensions are cut from the folded keys once per entry up front
+struct TypeLess {
+    const Listing& files;
+    const std::vector<std::string_view>& extensions;
+    bool operator()(uint32_t a, uint32_t b) const {
+        int c = CompareKeys(extensions[a], extensions[b]);
+        if (c != 0) return c < 0;
+        return NameLess{files}(a, b);
+    }
+};
+
+// One comparison of the full display order, matching what SortListing
+// produces; descending runs are the ascending ones reversed
+struct DisplayLess {
+    const Listing& files;
+    SortSpec spec;
+
+    bool Ascending(uint32_t a, uint32_t b) const {
+        switch (spec.column) {
+        case SortColumn::Size: return KeyLess<SizeKey>{files, SizeKey{}}(a, b);
+        case SortColumn::Date: return KeyLess<DateKey>{files, DateKey{}}(a, b);
+        case SortColumn::Type: {
+            // Only files reach here: folders always compare within their own group
+            int c = CompareKeys(FileExtension(files.Key(a)), FileExtension(files.Key(b)));
+            if (c != 0) return c < 0;
+            return NameLess{files}(a, b);
+        }
+        case SortColumn::Name:
+        default: return NameLess{files}(a, b);
+        }
+    }
+
+    bool operator()(uint32_t a, uint32_t b) const {
+        bool dir_a = files.IsDir(a), dir_b = files.IsDir(b);
+        if (dir_a != dir_b) return dir_a;
+        if (dir_a && spec.column == SortColumn::Type) {
+            // Folders have no extension, so Type orders them by name
+            return spec.ascending ? NameLess{files}(a, b) : NameLess{files}(b, a);
+        }
+        return spec.ascending ? Ascending(a, b) : Ascending(b, a);
+    }
+};
+
+// Past this share of the listing a full sort is cheaper than patching
+const size_t kPatchDivisor = 8;
+
+template <typename It>
+void SortRange(const Listing& files, const SortSpec& spec, It first, It last) {
+    switch (spec.column) {
+    case SortColumn::Name: {
+        size_t n = last - first;
+        if (n == 0) break;
+        uint32_t* begin = &*first;
+        if (n >= kParallelThreshold) {
+            ParallelMsdRadixSort(files, begin, begin + n);
+        } else if (n >= kRadixThreshold) {
+            std::vector<uint32_t> scratch;
+            MsdRadixSort(files, begin, begin + n, 0, scratch);
+        } else {
+            std::sort(first, last, NameLess{files});
+        }
+        break;
+    }
+    case SortColumn::Size:
+        std::sort(first, last, KeyLess<SizeKey>{files, SizeKey{}});
+        break;
+    case SortColumn::Date:
+        std::sort(first, last, KeyLess<DateKey>{files, DateKey{}});
+        break;
+    case SortColumn::Type: {
+        std::vector<std::string_view> extensions(files.size());
+        for (auto it = first; it != last; ++it) {
+            extensions[*it] = files.IsDir(*it) ? std::string_view() : FileExtension(files.Key(*it));
+        }
+        std::sort(first, last, TypeLess{files, extensions});
+        break;
+    }
+    }
+    if (!spec.ascending) std::reverse(first, last);
+}
+
+}
+
+std::string_view FileExtension(std::string_view name) {
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string_view::npos || dot == 0) return std::string_view();
+    return name.substr(dot + 1);
+}
+
+void SortListing(const Listing& files, const SortSpec& spec, std::vector<uint32_t>& order) {
+    order.resize(files.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    // Folders stay on top in either direction, like Explorer
+    auto folders_end = std::stable_partition(order.begin(), order.end(),
+        [&files](uint32_t i) { return files.IsDir(i); });
+    SortRange(files, spec, order.begin(), folders_end);
+    SortRange(files, spec, folders_end, order.end());
+}
+
+void PatchListing(Listing& files, std::vector<uint32_t>& order, const SortSpec& spec,
+                  const Listing& fresh, const ListingDiff& diff) {
+    if (diff.empty()) return;
+
+    bool small = order.size() == files.size() &&
+        diff.added.size() + diff.changed.size() + diff.removed.size() <= files.size() / kPatchDivisor;
+
+    // Changed entries move if the key they are sorted by moved with them
+    std::vector<uint8_t> moved(files.size(), 0);
+    for (const auto& change : diff.changed) {
+        uint32_t i = change.first;
+        if (spec.column == SortColumn::Size || spec.column == SortColumn::Date ||
+            files.IsDir(i) != fresh.IsDir(change.second)) {
+            moved[i] = 1;
+        }
+        files.UpdateFrom(i, fresh, change.second);
+    }
+
+    std::vector<uint32_t> remap;
+    if (!diff.removed.empty()) {
+        remap = files.Erase(diff.removed);
+    }
+    size_t kept = files.size();
+    for (uint32_t j : diff.added) files.Append(fresh, j, j + 1);
+
+    if (!small) {
+        SortListing(files, spec, order);
+        return;
+    }
+
+    // Survivors keep their relative order; movers are pulled out to re-place
+    std::vector<uint32_t> reinsert;
+    size_t out = 0;
+    for (uint32_t old_index : order) {
+        uint32_t i = remap.empty() ? old_index : remap[old_index];
+        if (i == kNoIndex) continue;
+        if (moved[old_index]) {
+            reinsert.push_back(i);
+            continue;
+        }
+        order[out++] = i;
+    }
+    order.resize(out);
+    for (size_t i = kept; i < files.size(); ++i) reinsert.push_back(static_cast<uint32_t>(i));
+
+    // One merge pass instead of an insert per entry, which is quadratic for
+    // patches near the threshold
+    DisplayLess less{files, spec};
+    std::sort(reinsert.begin(), reinsert.end(), less);
+    std::vector<uint32_t> merged(order.size() + reinsert.size());
+    std::merge(order.begin(), order.end(), reinsert.begin(), reinsert.end(), merged.begin(), less);
+    order.swap(merged);
+}
+
+}
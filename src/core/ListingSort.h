@@ -0,0 +1,39 @@
+#pragma once
+#include "Listing.h"
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+namespace core {
+
+enum class SortColumn {
+    Name = 0,
+    Size,
+    Type,
+    Date
+};
+
+struct SortSpec {
+    SortColumn column = SortColumn::Name;
+    bool ascending = true;
+
+    bool operator==(const SortSpec& o) const { return column == o.column && ascending == o.ascending; }
+    bool operator!=(const SortSpec& o) const { return !(*this == o); }
+};
+
+// Fills order with listing indices in display order: folders first, then
+// by the requested key with name as the tie break. The listing itself is
+// never moved.
+void SortListing(const Listing& files, const SortSpec& spec, std::vector<uint32_t>& order);
+
+// Brings files/order up to date with fresh (a newer listing of the same
+// directory) by applying only diff: unchanged entries keep their relative
+// order, new and changed ones are sorted and merged in. Falls back to a
+// full sort when the diff touches a large share of the listing.
+void PatchListing(Listing& files, std::vector<uint32_t>& order, const SortSpec& spec,
+                  const Listing& fresh, const ListingDiff& diff);
+
+// Extension used for the Type column ("" for folders and extensionless names)
+std::string_view FileExtension(std::string_view name);
+
+}
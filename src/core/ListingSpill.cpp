@@ -0,0 +1,77 @@
+#include "ListingSpill.h"
+#include "ListingCodec.h"
+#include "FileSystem.h"
+#include "MappedFile.h"
+#include <cstring>
+
+namespace core {
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint8_t column;
+    uint8_t ascending;
+    uint8_t has_order;
+    uint8_t reserved;
+    uint32_t path_length;
+};
+
+const char kMagic[4] = {'F', 'X', 'H', 'B'};
+
+}
+
+bool WriteListingSpill(const std::string& file, const Listing& listing,
+                       const std::vector<uint32_t>* order, SortSpec spec) {
+    bool has_order = order && order->size() == listing.size();
+    const std::string& path = listing.Parent();
+
+    std::string data;
+    FileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kListingSpillVersion;
+    header.entry_count = static_cast<uint32_t>(listing.size());
+    header.column = static_cast<uint8_t>(spec.column);
+    header.ascending = spec.ascending ? 1 : 0;
+    header.has_order = has_order ? 1 : 0;
+    header.path_length = static_cast<uint32_t>(path.size());
+    AppendRaw(data, header);
+    data += path;
+    EncodeListingEntries(listing, data);
+    if (has_order) EncodeListingOrder(*order, data);
+    return WriteFileReplacing(file, data);
+}
+
+bool ReadListingSpill(const std::string& file, SpilledListing& out) {
+    out = SpilledListing();
+    MappedFile mapped;
+    if (!mapped.Open(file)) return false;
+    ByteReader in{mapped.data(), mapped.data() + mapped.size()};
+
+    FileHeader header;
+    const char* path;
+    if (!in.Get(header)) return false;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kListingSpillVersion) return false;
+    if (header.column > static_cast<uint8_t>(SortColumn::Date) || !in.Bytes(header.path_length, path)) return false;
+
+    // Icon ids are taken as written: this runs on the UI thread, and spills
+    // never outlive the run that made the ids
+    auto listing = std::make_shared<Listing>(std::string(path, header.path_length));
+    if (!DecodeListingEntries(in, header.entry_count, true, *listing)) return false;
+
+    std::shared_ptr<std::vector<uint32_t>> order;
+    if (header.has_order) {
+        order = std::make_shared<std::vector<uint32_t>>();
+        if (!DecodeListingOrder(in, header.entry_count, *order)) return false;
+    }
+
+    out.listing = std::move(listing);
+    out.order = std::move(order);
+    out.spec.column = static_cast<SortColumn>(header.column);
+    out.spec.ascending = header.ascending != 0;
+    return true;
+}
+
+}
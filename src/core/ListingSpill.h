@@ -0,0 +1,29 @@
+#pragma once
+#include "Listing.h"
+#include "ListingSort.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace core {
+
+// A listing read back from a spill file
+struct SpilledListing {
+    std::shared_ptr<const Listing> listing;
+    std::shared_ptr<const std::vector<uint32_t>> order; // Null if none was spilled
+    SortSpec spec;
+};
+
+// Spill files hold one listing of a hibernated tab for the rest of the run
+// (see HibernateTab). Unlike the session file there is no size cap: a tab
+// is spilled whole or not at all. Entries keep their collation keys and
+// icon ids (see ListingCodec.h), so reading one back does no per-name work.
+bool WriteListingSpill(const std::string& file, const Listing& listing,
+                       const std::vector<uint32_t>* order, SortSpec spec);
+// False if the file is missing, damaged or from another version
+bool ReadListingSpill(const std::string& file, SpilledListing& out);
+
+const uint32_t kListingSpillVersion = 2;
+
+}
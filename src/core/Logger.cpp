@@ -1,26 +1,291 @@
 #include "Logger.h"
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <ctime>
-#include <iomanip>
+#include <filesystem>
+
+namespace fs = std::filesystem;
 
 namespace core {
 
-static std::ofstream g_log_file;
+namespace {
+
+// Record layout in a ring: header, then the text, padded to 8 bytes
+struct RecordHeader {
+    uint32_t size; // Header, text and padding
+    uint8_t level;
+    uint8_t reserved;
+    uint16_t length; // Of the text
+    int64_t time_ns; // Since the Unix epoch
+};
+
+const uint8_t kWrapMarker = 0xFF; // Rest of the ring up to its end is unused
+const size_t kAlign = 8;
+// Longer messages are cut so one record can't hog the ring
+const size_t kMaxText = Logger::kRingBytes / 4 - sizeof(RecordHeader);
+
+size_t Align(size_t n) {
+    return (n + kAlign - 1) & ~(kAlign - 1);
+}
+
+std::atomic<uint64_t> g_next_logger_id{1};
+
+const char* LevelName(uint8_t level) {
+    switch (static_cast<LogLevel>(level)) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO ";
+        case LogLevel::Warn: return "WARN ";
+        case LogLevel::Error: return "ERROR";
+        default: return "?    ";
+    }
+}
+
+std::tm LocalTime(std::time_t t) {
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &t);
+#else
+    localtime_r(&t, &tm);
+#endif
+    return tm;
+}
+
+}
+
+// Single producer (the owning thread), single consumer (whoever holds
+// drain_mutex). Positions only grow; the mask maps them into the buffer.
+struct Logger::Ring {
+    alignas(64) std::atomic<uint64_t> head{0}; // Written by the producer
+    alignas(64) std::atomic<uint64_t> tail{0}; // Written by the consumer
+    uint64_t cached_tail = 0; // Producer's last look at tail
+    uint8_t buffer[kRingBytes];
+
+    bool Push(LogLevel level, int64_t time_ns, const char* text, size_t length) {
+        length = std::min(length, kMaxText);
+        size_t need = Align(sizeof(RecordHeader) + length);
+        uint64_t h = head.load(std::memory_order_relaxed);
+        size_t pos = static_cast<size_t>(h & (kRingBytes - 1));
+        size_t contiguous = kRingBytes - pos;
+        size_t total = need > contiguous ? contiguous + need : need;
 
-void Init(const std::string& path) {
-    if (g_log_file.is_open()) {
-        g_log_file.close();
+        if (h + total - cached_tail > kRingBytes) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h + total - cached_tail > kRingBytes) return false;
+        }
+        if (need > contiguous) {
+            // Skip to the start; contiguous is at least kAlign bytes
+            uint32_t skip = static_cast<uint32_t>(contiguous);
+            std::memcpy(buffer + pos, &skip, sizeof(skip));
+            buffer[pos + offsetof(RecordHeader, level)] = kWrapMarker;
+            pos = 0;
+        }
+
+        RecordHeader header;
+        header.size = static_cast<uint32_t>(need);
+        header.level = static_cast<uint8_t>(level);
+        header.reserved = 0;
+        header.length = static_cast<uint16_t>(length);
+        header.time_ns = time_ns;
+        std::memcpy(buffer + pos, &header, sizeof(header));
+        std::memcpy(buffer + pos + sizeof(header), text, length);
+        head.store(h + total, std::memory_order_release);
+        return true;
     }
-    g_log_file.open(path, std::ios::out | std::ios::app);
+};
+
+Logger& Logger::Get() {
+    static Logger instance;
+    return instance;
+}
+
+Logger::Logger()
+    : min_level(FLASH_LOG_LEVEL), id(g_next_logger_id.fetch_add(1)) {}
+
+Logger::~Logger() {
+    Close();
+}
+
+bool Logger::Open(const std::string& log_path, size_t max_size, int keep) {
+    Close();
+    {
+        std::lock_guard<std::mutex> lock(drain_mutex);
+        file = std::fopen(log_path.c_str(), "ab");
+        if (!file) return false;
+        path = log_path;
+        max_bytes = max_size;
+        keep_files = std::max(keep, 0);
+        std::error_code ec;
+        uintmax_t size = fs::file_size(log_path, ec);
+        file_bytes = ec ? 0 : static_cast<size_t>(size);
+    }
+    {
+        std::lock_guard<std::mutex> lock(flusher_mutex);
+        stopping = false;
+    }
+    accepting.store(true);
+    flusher = std::thread(&Logger::FlusherLoop, this);
+    return true;
+}
+
+void Logger::Close() {
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(flusher_mutex);
+            stopping = true;
+        }
+        flusher_cv.notify_all();
+        flusher.join();
+    }
+    accepting.store(false);
+    std::lock_guard<std::mutex> lock(drain_mutex);
+    // Records made before the first Open stay queued for it
+    if (file) {
+        DrainLocked();
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+Logger::Ring* Logger::ThreadRing() {
+    // Registered on a thread's first record; the registry keeps the ring
+    // until the flusher has drained it after the thread is gone
+    struct Cache {
+        uint64_t owner = 0;
+        std::shared_ptr<Ring> ring;
+    };
+    thread_local Cache cache;
+    if (cache.owner != id) {
+        cache.ring = std::make_shared<Ring>();
+        cache.owner = id;
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.push_back(cache.ring);
+    }
+    return cache.ring.get();
+}
+
+void Logger::Write(LogLevel level, const char* text, size_t length) {
+    if (!Enabled(level)) return;
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (!ThreadRing()->Push(level, now, text, length)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Logger::Flush() {
+    std::lock_guard<std::mutex> lock(drain_mutex);
+    DrainLocked();
+}
+
+void Logger::FlusherLoop() {
+    std::unique_lock<std::mutex> lock(flusher_mutex);
+    while (!stopping) {
+        flusher_cv.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs));
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+void Logger::DrainLocked() {
+    std::vector<std::shared_ptr<Ring>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        snapshot = rings;
+    }
+
+    struct Entry {
+        int64_t time_ns;
+        uint8_t level;
+        size_t offset;
+        size_t length;
+    };
+    std::vector<Entry> entries;
+    std::string text;
+    std::vector<Ring*> finished;
+    for (const auto& ring : snapshot) {
+        // Two owners left (the registry and this snapshot) means the thread is gone
+        bool orphaned = ring.use_count() <= 2;
+        uint64_t t = ring->tail.load(std::memory_order_relaxed);
+        uint64_t h = ring->head.load(std::memory_order_acquire);
+        while (t < h) {
+            size_t pos = static_cast<size_t>(t & (kRingBytes - 1));
+            uint32_t size;
+            std::memcpy(&size, ring->buffer + pos, sizeof(size));
+            if (ring->buffer[pos + offsetof(RecordHeader, level)] != kWrapMarker) {
+                RecordHeader header;
+                std::memcpy(&header, ring->buffer + pos, sizeof(header));
+                entries.push_back({header.time_ns, header.level, text.size(), header.length});
+                text.append(reinterpret_cast<const char*>(ring->buffer + pos + sizeof(header)), header.length);
+            }
+            t += size;
+        }
+        ring->tail.store(t, std::memory_order_release);
+        if (orphaned && t == ring->head.load(std::memory_order_acquire)) finished.push_back(ring.get());
+    }
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.erase(std::remove_if(rings.begin(), rings.end(), [&](const std::shared_ptr<Ring>& r) {
+            return std::find(finished.begin(), finished.end(), r.get()) != finished.end();
+        }), rings.end());
+    }
+
+    uint64_t lost = dropped.load(std::memory_order_relaxed);
+    if (entries.empty() && lost == reported_dropped) return;
+    if (!file) return;
+
+    // Threads drain in turn; put their records back in time order
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.time_ns < b.time_ns; });
+
+    std::string out;
+    out.reserve(text.size() + entries.size() * 32);
+    char prefix[64];
+    std::time_t prefix_second = -1;
+    char stamp[32] = "";
+    for (const Entry& e : entries) {
+        std::time_t second = static_cast<std::time_t>(e.time_ns / 1000000000);
+        if (second != prefix_second) {
+            std::tm tm = LocalTime(second);
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+            prefix_second = second;
+        }
+        int millis = static_cast<int>((e.time_ns / 1000000) % 1000);
+        int n = std::snprintf(prefix, sizeof(prefix), "[%s.%03d] %s ", stamp, millis, LevelName(e.level));
+        out.append(prefix, n);
+        out.append(text, e.offset, e.length);
+        out += '\n';
+    }
+    if (lost != reported_dropped) {
+        out += "[log] " + std::to_string(lost - reported_dropped) + " records dropped, ring full\n";
+        reported_dropped = lost;
+    }
+
+    std::fwrite(out.data(), 1, out.size(), file);
+    std::fflush(file);
+    file_bytes += out.size();
+    if (max_bytes > 0 && file_bytes >= max_bytes) RotateLocked();
 }
 
-void Log(const std::string& msg) {
-    if (g_log_file.is_open()) {
-        auto t = std::time(nullptr);
-        auto tm = *std::localtime(&t);
-        g_log_file << std::put_time(&tm, "[%Y-%m-%d %H:%M:%S] ") << msg << std::endl;
-        g_log_file.flush();
+void Logger::RotateLocked() {
+    std::fclose(file);
+    file = nullptr;
+    std::error_code ec;
+    if (keep_files == 0) {
+        fs::remove(path, ec);
+    } else {
+        // path.N-1 -> path.N, ..., path -> path.1; the oldest falls off
+        fs::remove(path + "." + std::to_string(keep_files), ec);
+        for (int i = keep_files - 1; i >= 1; --i) {
+            fs::rename(path + "." + std::to_string(i), path + "." + std::to_string(i + 1), ec);
+        }
+        fs::rename(path, path + ".1", ec);
     }
+    file = std::fopen(path.c_str(), "ab");
+    file_bytes = 0;
+    if (!file) accepting.store(false);
 }
 
 }
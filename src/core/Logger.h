@@ -1,7 +1,120 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
 
 namespace core {
-    void Init(const std::string& path);
-    void Log(const std::string& msg);
+
+enum class LogLevel : int {
+    Trace = 0,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+// Levels below this are compiled out of LOG_* call sites, arguments and all
+#ifndef FLASH_LOG_LEVEL
+#ifdef NDEBUG
+#define FLASH_LOG_LEVEL 2 // Info
+#else
+#define FLASH_LOG_LEVEL 1 // Debug
+#endif
+#endif
+
+// Asynchronous log file. Each thread writes records into its own lock-free
+// single-producer ring; a background thread drains all rings every
+// kFlushInterval, orders the batch by time, formats it and writes it with
+// one call. The file rotates to path.1 .. path.N past max_bytes.
+//
+// Writing costs a clock read and a copy into the ring. A full ring drops
+// the record and counts it rather than blocking the caller.
+class Logger {
+public:
+    static Logger& Get();
+
+    Logger();
+    ~Logger();
+
+    // Appends to path. Records made before Open wait in their ring (and are
+    // dropped once it fills), so the file can be opened off the UI thread.
+    bool Open(const std::string& path, size_t max_bytes = kDefaultMaxBytes, int keep_files = kDefaultKeepFiles);
+    // Drains and closes the file; the flusher thread ends and records are
+    // ignored until the next Open
+    void Close();
+
+    void SetLevel(LogLevel level) { min_level.store(static_cast<int>(level), std::memory_order_relaxed); }
+    LogLevel Level() const { return static_cast<LogLevel>(min_level.load(std::memory_order_relaxed)); }
+    bool Enabled(LogLevel level) const {
+        return static_cast<int>(level) >= min_level.load(std::memory_order_relaxed) &&
+            accepting.load(std::memory_order_relaxed);
+    }
+
+    void Write(LogLevel level, const char* text, size_t length);
+    void Write(LogLevel level, const std::string& text) { Write(level, text.data(), text.size()); }
+
+    // Writes everything logged so far, on the calling thread
+    void Flush();
+    uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    static const size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+    static const int kDefaultKeepFiles = 3;
+    static const size_t kRingBytes = 64 * 1024; // Per thread, power of two
+    static constexpr int kFlushIntervalMs = 50;
+
+private:
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    struct Ring;
+    Ring* ThreadRing();
+    void FlusherLoop();
+    // Callers hold drain_mutex
+    void DrainLocked();
+    void RotateLocked();
+
+    std::atomic<int> min_level;
+    std::atomic<bool> accepting{true}; // Until Close; records queue for the first Open
+    std::atomic<uint64_t> dropped{0};
+    uint64_t reported_dropped = 0;
+    const uint64_t id; // Tells loggers apart in the thread-local ring cache
+
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+
+    std::mutex drain_mutex; // One consumer at a time; owns the fields below
+    FILE* file = nullptr;
+    std::string path;
+    size_t max_bytes = kDefaultMaxBytes;
+    int keep_files = kDefaultKeepFiles;
+    size_t file_bytes = 0;
+
+    std::thread flusher;
+    std::mutex flusher_mutex;
+    std::condition_variable flusher_cv;
+    bool stopping = false;
+};
+
 }
+
+#define FLASH_LOG(level, text)                                              \
+    do {                                                                    \
+        if (static_cast<int>(level) >= FLASH_LOG_LEVEL &&                   \
+            ::core::Logger::Get().Enabled(level)) {                         \
+            ::core::Logger::Get().Write(level, text);                       \
+        }                                                                   \
+    } while (0)
+
+#define LOG_TRACE(text) FLASH_LOG(::core::LogLevel::Trace, text)
+#define LOG_DEBUG(text) FLASH_LOG(::core::LogLevel::Debug, text)
+#define LOG_INFO(text) FLASH_LOG(::core::LogLevel::Info, text)
+#define LOG_WARN(text) FLASH_LOG(::core::LogLevel::Warn, text)
+#define LOG_ERROR(text) FLASH_LOG(::core::LogLevel::Error, text)
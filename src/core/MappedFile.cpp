@@ -0,0 +1,83 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include "WideString.h"
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace core {
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    // Share everything so another instance can still replace the file
+    HANDLE file = CreateFileW(ToWide(path).c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    // The mapping keeps its own reference to the file
+    HANDLE map = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!map) return false;
+
+    void* p = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (!p) {
+        CloseHandle(map);
+        return false;
+    }
+    mapping = map;
+    view = static_cast<const uint8_t*>(p);
+    length = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+    view = nullptr;
+    mapping = nullptr;
+    length = 0;
+}
+#else
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    // The mapping outlives the descriptor
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+
+    view = static_cast<const uint8_t*>(p);
+    length = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (view) munmap(const_cast<uint8_t*>(view), length);
+    view = nullptr;
+    length = 0;
+}
+#endif
+
+}
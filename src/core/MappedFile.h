@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace core {
+
+// Read-only mapping of a whole file. Pages load on first touch, so opening
+// a large file costs next to nothing until it is read.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // False if the file is missing, empty or cannot be mapped
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return view != nullptr; }
+    const uint8_t* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* mapping = nullptr; // HANDLE
+#endif
+};
+
+}
@@ -0,0 +1,152 @@
+#include "Metrics.h"
+#include "FileSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+
+namespace core {
+
+namespace {
+
+int HighestBit(uint64_t v) {
+    int bit = 0;
+    while (v >>= 1) ++bit;
+    return bit;
+}
+
+std::string Millis(uint64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(ns) / 1e6);
+    return text;
+}
+
+}
+
+Histogram::Histogram() {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+int Histogram::BucketOf(uint64_t ns) {
+    if (ns < static_cast<uint64_t>(kSubBuckets)) return static_cast<int>(ns);
+    int top = HighestBit(ns); // >= kSubBits
+    int shift = top - kSubBits;
+    int sub = static_cast<int>((ns >> shift) & (kSubBuckets - 1));
+    return kSubBuckets + shift * kSubBuckets + sub;
+}
+
+uint64_t Histogram::BucketLow(int bucket) {
+    if (bucket < kSubBuckets) return static_cast<uint64_t>(bucket);
+    int shift = (bucket - kSubBuckets) / kSubBuckets;
+    int sub = (bucket - kSubBuckets) % kSubBuckets;
+    return static_cast<uint64_t>(kSubBuckets + sub) << shift;
+}
+
+uint64_t Histogram::BucketHigh(int bucket) {
+    if (bucket < kSubBuckets) return static_cast<uint64_t>(bucket) + 1;
+    int shift = (bucket - kSubBuckets) / kSubBuckets;
+    return BucketLow(bucket) + (uint64_t(1) << shift);
+}
+
+void Histogram::Record(uint64_t ns) {
+    buckets[BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (ns > seen && !max.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::Percentile(double q) const {
+    // Bucket counts are read one by one while others record, so use their
+    // own total rather than count
+    uint64_t total = 0;
+    uint64_t counts[kBuckets];
+    for (int i = 0; i < kBuckets; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            // Middle of the bucket, but never past the largest sample
+            uint64_t mid = BucketLow(i) + (BucketHigh(i) - 1 - BucketLow(i)) / 2;
+            return std::min(mid, Max());
+        }
+    }
+    return Max();
+}
+
+Metrics& Metrics::Get() {
+    static Metrics instance;
+    return instance;
+}
+
+Metrics::Metrics() : started(std::chrono::steady_clock::now()) {}
+
+Counter& Metrics::GetCounter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = counters[name];
+    if (!slot) slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Gauge& Metrics::GetGauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = gauges[name];
+    if (!slot) slot = std::make_unique<Gauge>();
+    return *slot;
+}
+
+Histogram& Metrics::GetHistogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = histograms[name];
+    if (!slot) slot = std::make_unique<Histogram>();
+    return *slot;
+}
+
+std::string Metrics::Format() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    for (const auto& entry : counters) {
+        out += "counter " + entry.first + " " + std::to_string(entry.second->Value()) + "\n";
+    }
+    for (const auto& entry : gauges) {
+        out += "gauge " + entry.first + " " + std::to_string(entry.second->Value()) + "\n";
+    }
+    for (const auto& entry : histograms) {
+        const Histogram& h = *entry.second;
+        uint64_t n = h.Count();
+        out += "histogram " + entry.first + " count=" + std::to_string(n);
+        if (n > 0) {
+            out += " mean=" + Millis(h.Sum() / n) + "ms p50=" + Millis(h.Percentile(0.5)) +
+                "ms p90=" + Millis(h.Percentile(0.9)) + "ms p99=" + Millis(h.Percentile(0.99)) +
+                "ms max=" + Millis(h.Max()) + "ms";
+        }
+        out += "\n";
+    }
+    return out;
+}
+
+bool Metrics::DumpTo(const std::string& path) {
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &now);
+#else
+    localtime_r(&now, &tm);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+    long long uptime = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - started).count();
+    std::string text = std::string("# metrics at ") + stamp + ", uptime " + std::to_string(uptime) + " s\n" + Format();
+
+    return WriteFileReplacing(path, text);
+}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace core {
+
+// Monotonic count of events
+class Counter {
+public:
+    void Add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Value() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+// Level that goes up and down
+class Gauge {
+public:
+    void Set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void Add(int64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+    int64_t Value() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value{0};
+};
+
+// Durations in nanoseconds, bucketed HDR style: exact below kSubBuckets,
+// then kSubBuckets buckets per power of two, so any percentile is within
+// 1/kSubBuckets (about 6%) of the true value. Recording is a few bit
+// operations and relaxed atomic adds.
+class Histogram {
+public:
+    static const int kSubBits = 4;
+    static const int kSubBuckets = 1 << kSubBits;
+    static const int kBuckets = kSubBuckets + (64 - kSubBits) * kSubBuckets;
+
+    Histogram();
+
+    void Record(uint64_t ns);
+    uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+    uint64_t Sum() const { return sum.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return max.load(std::memory_order_relaxed); }
+    // Value at or below which fraction q (0..1) of the samples fall
+    uint64_t Percentile(double q) const;
+
+    static int BucketOf(uint64_t ns);
+    static uint64_t BucketLow(int bucket);
+    static uint64_t BucketHigh(int bucket); // Exclusive
+
+private:
+    std::atomic<uint64_t> buckets[kBuckets];
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+// Records the time from construction to destruction
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        histogram.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+
+private:
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Named metrics for the whole app. Lookups lock; the metrics themselves
+// never move, so hot paths look one up once and keep the reference:
+//   static Counter& loads = Metrics::Get().GetCounter("load.count");
+class Metrics {
+public:
+    static Metrics& Get();
+
+    Metrics();
+
+    Counter& GetCounter(const std::string& name);
+    Gauge& GetGauge(const std::string& name);
+    Histogram& GetHistogram(const std::string& name);
+
+    // One metric per line, names sorted; histograms in milliseconds
+    std::string Format();
+    // Replaces path with Format() under a header; false if it can't be written
+    bool DumpTo(const std::string& path);
+
+private:
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    const std::chrono::steady_clock::time_point started;
+};
+
+}
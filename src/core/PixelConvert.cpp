@@ -0,0 +1,205 @@
+#include "PixelConvert.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PIXEL_CONVERT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PIXEL_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+// MSVC emits AVX2 intrinsics without per-function opt-in; GCC and Clang need it
+#if defined(PIXEL_CONVERT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PIXEL_CONVERT_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define PIXEL_CONVERT_AVX2_TARGET
+#endif
+
+namespace core {
+
+namespace {
+
+// round(c * a / 255), exact for all 8-bit c and a
+inline uint8_t MulDiv255(unsigned c, unsigned a) {
+    unsigned t = c * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+using ConvertFn = void (*)(const uint8_t*, uint8_t*, size_t, bool);
+
+#if defined(PIXEL_CONVERT_X86)
+
+// Pixels read as little-endian uint32 are 0xAARRGGBB; RGBA wants 0xAABBGGRR
+inline __m128i SwapRedBlue(__m128i v) {
+    const __m128i ag = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+    const __m128i low = _mm_set1_epi32(0xFF);
+    __m128i red = _mm_and_si128(_mm_srli_epi32(v, 16), low);
+    __m128i blue = _mm_slli_epi32(_mm_and_si128(v, low), 16);
+    return _mm_or_si128(_mm_and_si128(v, ag), _mm_or_si128(red, blue));
+}
+
+// Two RGBA pixels widened to 16-bit lanes; alpha multiplies by 255, i.e. stays
+inline __m128i Premultiply16(__m128i x) {
+    const __m128i alpha_lane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i color_lanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm_or_si128(_mm_and_si128(a, color_lanes), alpha_lane);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+void ConvertSse2(const uint8_t* src, uint8_t* dst, size_t pixels, bool premultiply) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i v = SwapRedBlue(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4)));
+        if (premultiply) {
+            __m128i lo = Premultiply16(_mm_unpacklo_epi8(v, zero));
+            __m128i hi = Premultiply16(_mm_unpackhi_epi8(v, zero));
+            v = _mm_packus_epi16(lo, hi);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), v);
+    }
+    ConvertBgraToRgbaScalar(src + i * 4, dst + i * 4, pixels - i, premultiply);
+}
+
+PIXEL_CONVERT_AVX2_TARGET
+inline __m256i SwapRedBlue256(__m256i v) {
+    const __m256i ag = _mm256_set1_epi32(static_cast<int>(0xFF00FF00));
+    const __m256i low = _mm256_set1_epi32(0xFF);
+    __m256i red = _mm256_and_si256(_mm256_srli_epi32(v, 16), low);
+    __m256i blue = _mm256_slli_epi32(_mm256_and_si256(v, low), 16);
+    return _mm256_or_si256(_mm256_and_si256(v, ag), _mm256_or_si256(red, blue));
+}
+
+PIXEL_CONVERT_AVX2_TARGET
+inline __m256i Premultiply16x2(__m256i x) {
+    const __m256i alpha_lane = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    const __m256i color_lanes = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm256_or_si256(_mm256_and_si256(a, color_lanes), alpha_lane);
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, a), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+// Unpack and pack both work within 128-bit halves, so pixel order survives
+PIXEL_CONVERT_AVX2_TARGET
+void ConvertAvx2(const uint8_t* src, uint8_t* dst, size_t pixels, bool premultiply) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i v = SwapRedBlue256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4)));
+        if (premultiply) {
+            __m256i lo = Premultiply16x2(_mm256_unpacklo_epi8(v, zero));
+            __m256i hi = Premultiply16x2(_mm256_unpackhi_epi8(v, zero));
+            v = _mm256_packus_epi16(lo, hi);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), v);
+    }
+    // Leftovers (icons are usually a multiple of 8 wide) go through SSE2
+    ConvertSse2(src + i * 4, dst + i * 4, pixels - i, premultiply);
+}
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // The OS must save YMM state across context switches
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#elif defined(PIXEL_CONVERT_NEON)
+
+// c * a / 255 rounded, on eight lanes at a time
+inline uint8x8_t MulDiv255x8(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t t = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vsraq_n_u16(t, t, 8), 8);
+}
+
+inline uint8x16_t MulDiv255x16(uint8x16_t c, uint8x16_t a) {
+    return vcombine_u8(MulDiv255x8(vget_low_u8(c), vget_low_u8(a)),
+                       MulDiv255x8(vget_high_u8(c), vget_high_u8(a)));
+}
+
+void ConvertNeon(const uint8_t* src, uint8_t* dst, size_t pixels, bool premultiply) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        // De-interleaving load hands us the channels as separate planes
+        uint8x16x4_t bgra = vld4q_u8(src + i * 4);
+        uint8x16x4_t rgba;
+        rgba.val[0] = bgra.val[2];
+        rgba.val[1] = bgra.val[1];
+        rgba.val[2] = bgra.val[0];
+        rgba.val[3] = bgra.val[3];
+        if (premultiply) {
+            for (int c = 0; c < 3; ++c) rgba.val[c] = MulDiv255x16(rgba.val[c], rgba.val[3]);
+        }
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    ConvertBgraToRgbaScalar(src + i * 4, dst + i * 4, pixels - i, premultiply);
+}
+
+#endif
+
+struct Kernel {
+    ConvertFn fn;
+    const char* name;
+};
+
+Kernel SelectKernel() {
+#if defined(PIXEL_CONVERT_X86)
+    if (CpuHasAvx2()) return {ConvertAvx2, "avx2"};
+    return {ConvertSse2, "sse2"}; // Baseline on x86-64
+#elif defined(PIXEL_CONVERT_NEON)
+    return {ConvertNeon, "neon"}; // Baseline on AArch64
+#else
+    return {ConvertBgraToRgbaScalar, "scalar"};
+#endif
+}
+
+const Kernel& ActiveKernel() {
+    static const Kernel kernel = SelectKernel();
+    return kernel;
+}
+
+}
+
+void ConvertBgraToRgbaScalar(const uint8_t* src, uint8_t* dst, size_t pixels, bool premultiply) {
+    for (size_t i = 0; i < pixels; ++i) {
+        const uint8_t* s = src + i * 4;
+        uint8_t* d = dst + i * 4;
+        uint8_t b = s[0], g = s[1], r = s[2], a = s[3];
+        if (premultiply) {
+            r = MulDiv255(r, a);
+            g = MulDiv255(g, a);
+            b = MulDiv255(b, a);
+        }
+        d[0] = r;
+        d[1] = g;
+        d[2] = b;
+        d[3] = a;
+    }
+}
+
+void ConvertBgraToRgba(const uint8_t* src, uint8_t* dst, size_t pixels, bool premultiply) {
+    ActiveKernel().fn(src, dst, pixels, premultiply);
+}
+
+const char* PixelConvertKernel() {
+    return ActiveKernel().name;
+}
+
+}
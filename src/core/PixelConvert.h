@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace core {
+
+// Swaps BGRA (Windows DIB order) to RGBA (what Fl_RGB_Image takes) for
+// `pixels` 4-byte pixels. src and dst may be the same buffer but must not
+// otherwise overlap. With premultiply, colour channels are scaled by
+// alpha as round(c * a / 255).
+// Picks the widest kernel the CPU supports (AVX2, SSE2, NEON), once.
+void ConvertBgraToRgba(const uint8_t* src, uint8_t* dst, size_t pixels, bool premultiply = false);
+
+// Reference implementation; every vector path must match it bit for bit
+void ConvertBgraToRgbaScalar(const uint8_t* src, uint8_t* dst, size_t pixels, bool premultiply);
+
+// "avx2", "sse2", "neon" or "scalar"
+const char* PixelConvertKernel();
+
+}
@@ -1,142 +1,366 @@
 #include "QuickAccess.h"
 #include "FileSystem.h"
+#include "StartupProfiler.h"
 #include <fstream>
 #include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
 #include <shlobj.h>
 #include <windows.h>
-#include <filesystem>
+#endif
+
+namespace fs = std::filesystem;
 
 namespace core {
 
+namespace {
+
+// Journal operations
+const char kVisit = 'V';
+const char kPin = 'P';
+const char kUnpin = 'U';
+
+size_t CountLines(const std::string& text) {
+    return static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+int64_t NowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool AppendFile(const std::string& path, const std::string& text) {
+    FILE* f = std::fopen(path.c_str(), "ab");
+    if (!f) return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+}
+
 QuickAccess& QuickAccess::Get() {
-    static QuickAccess instance;
+    static QuickAccess instance(GetConfigDir() + "/quick_access.txt", TaskScheduler::Get(), false);
     return instance;
 }
 
-QuickAccess::QuickAccess() {
-    // Determine save path
-    save_path = GetConfigDir() + "\\quick_access.txt";
-    Load();
+QuickAccess::QuickAccess(const std::string& save_path, TaskScheduler& scheduler, bool load_now)
+    : state(std::make_shared<State>()), scheduler(scheduler) {
+    state->save_path = save_path;
+    fs::path journal(save_path);
+    journal.replace_extension(".journal");
+    state->journal_path = journal.string();
+    if (load_now) {
+        Load();
+        return;
+    }
+    std::shared_ptr<State> shared = state;
+    scheduler.Submit(TaskPriority::ActiveTab, [shared, &scheduler]() { LoadState(shared, scheduler); });
 }
 
 QuickAccess::~QuickAccess() {
-    Save();
+    // Appending is enough; the next run replays the journal
+    Flush();
+}
+
+bool QuickAccess::ApplyLocked(State& state, char op, int64_t when, const std::string& path) {
+    auto& pinned = state.pinned_paths;
+    if (op == kVisit) {
+        state.frecency.Visit(path, when);
+        return true;
+    } else if (op == kPin) {
+        if (!state.pinned_set.insert(path).second) return false;
+        pinned.push_back(path);
+        return true;
+    } else if (op == kUnpin) {
+        if (!state.pinned_set.erase(path)) return false;
+        pinned.erase(std::remove(pinned.begin(), pinned.end(), path), pinned.end());
+        return true;
+    }
+    return false;
+}
+
+// seq|op|when|path, with the path last so it may hold '|'
+void QuickAccess::RecordLocked(State& state, char op, int64_t when, const std::string& path) {
+    state.pending += std::to_string(state.next_sequence++);
+    state.pending += '|';
+    state.pending += op;
+    state.pending += '|';
+    state.pending += std::to_string(when);
+    state.pending += '|';
+    state.pending += path;
+    state.pending += '\n';
+}
+
+void QuickAccess::QueueWrite(const std::shared_ptr<State>& state, TaskScheduler& scheduler) {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->flush_queued) return;
+        state->flush_queued = true;
+    }
+    // One write covers everything recorded until it runs
+    std::shared_ptr<State> shared = state;
+    scheduler.Submit(TaskPriority::Indexing, [shared]() { WriteState(*shared, false); });
+}
+
+void QuickAccess::Notify(State& state) {
+    std::function<void()> cb;
+    {
+        std::lock_guard<std::mutex> lock(state.callback_mutex);
+        cb = state.on_update;
+    }
+    if (cb) cb();
+}
+
+void QuickAccess::Changed(char op, int64_t when, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->loaded) {
+            // Applied on top of the files once they are read
+            state->early.push_back({op, {when, path}});
+            return;
+        }
+        if (!ApplyLocked(*state, op, when, path)) return;
+        RecordLocked(*state, op, when, path);
+    }
+    QueueWrite(state, scheduler);
+    Notify(*state);
 }
 
 void QuickAccess::AddVisit(const std::string& path) {
-    std::lock_guard<std::mutex> lock(mutex);
-    visit_counts[path]++;
-    Save();
-    if (on_update) on_update();
+    AddVisit(path, NowSeconds());
+}
+
+void QuickAccess::AddVisit(const std::string& path, int64_t when) {
+    Changed(kVisit, when, path);
 }
 
 void QuickAccess::SetUpdateCallback(std::function<void()> cb) {
-    std::lock_guard<std::mutex> lock(mutex);
-    on_update = cb;
+    std::lock_guard<std::mutex> lock(state->callback_mutex);
+    state->on_update = cb;
 }
 
 void QuickAccess::Pin(const std::string& path) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (std::find(pinned_paths.begin(), pinned_paths.end(), path) == pinned_paths.end()) {
-        pinned_paths.push_back(path);
-        Save();
-        if (on_update) on_update();
-    }
+    Changed(kPin, NowSeconds(), path);
 }
 
 void QuickAccess::Unpin(const std::string& path) {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto it = std::remove(pinned_paths.begin(), pinned_paths.end(), path);
-    if (it != pinned_paths.end()) {
-        pinned_paths.erase(it, pinned_paths.end());
-        Save();
-        if (on_update) on_update();
-    }
+    Changed(kUnpin, NowSeconds(), path);
 }
 
 bool QuickAccess::IsPinned(const std::string& path) {
-    std::lock_guard<std::mutex> lock(mutex);
-    return std::find(pinned_paths.begin(), pinned_paths.end(), path) != pinned_paths.end();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->pinned_set.count(path) != 0;
+}
+
+bool QuickAccess::IsLoaded() {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->loaded;
+}
+
+void QuickAccess::WaitUntilLoaded() {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->loaded_cv.wait(lock, [this]() { return state->loaded; });
 }
 
 std::vector<QuickAccess::Item> QuickAccess::GetItems(int limit) {
-    std::lock_guard<std::mutex> lock(mutex);
-    
+    int64_t now = NowSeconds();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    const FrecencyIndex& frecency = state->frecency;
+
     std::vector<Item> result;
-    
+
     // Add pinned items first
-    for (const auto& path : pinned_paths) {
-        result.push_back({path, visit_counts[path], true});
+    for (const auto& path : state->pinned_paths) {
+        const FrecencyIndex::Entry* entry = frecency.Find(path);
+        if (entry) result.push_back({path, entry->count, true, FrecencyIndex::Score(*entry, now), entry->last_visit});
+        else result.push_back({path, 0, true, 0.0, 0});
     }
-    
-    // Add frequent items (excluding pinned)
-    std::vector<std::pair<std::string, int>> items;
-    for (const auto& pair : visit_counts) {
-        if (std::find(pinned_paths.begin(), pinned_paths.end(), pair.first) == pinned_paths.end()) {
-            items.push_back(pair);
-        }
-    }
-    
-    std::sort(items.begin(), items.end(), [](const auto& a, const auto& b) {
-        return a.second > b.second;
-    });
-    
-    for (int i = 0; i < items.size() && result.size() < limit; ++i) {
-        result.push_back({items[i].first, items[i].second, false});
+
+    // Then the most frecent, walking the heap past any pinned ones
+    size_t wanted = limit > static_cast<int>(result.size()) ? limit - result.size() : 0;
+    auto pinned = [this](const FrecencyIndex::Entry& entry) { return state->pinned_set.count(entry.path) != 0; };
+    for (const FrecencyIndex::Entry* entry : frecency.Top(wanted, pinned)) {
+        result.push_back({entry->path, entry->count, false, FrecencyIndex::Score(*entry, now), entry->last_visit});
     }
-    
+
     return result;
 }
 
-void QuickAccess::Save() {
-    if (save_path.empty()) return;
-    
-    std::ofstream out(save_path);
-    if (out.is_open()) {
-        out << "[Pinned]\n";
-        for (const auto& path : pinned_paths) {
-            out << path << "\n";
-        }
-        out << "[Visits]\n";
-        for (const auto& pair : visit_counts) {
-            out << pair.first << "|" << pair.second << "\n";
+bool QuickAccess::Save() {
+    return WriteState(*state, true);
+}
+
+bool QuickAccess::Flush() {
+    return WriteState(*state, false);
+}
+
+bool QuickAccess::WriteState(State& state, bool compact) {
+    // Writers share the temp file, and appends must land in sequence order
+    static std::mutex write_mutex;
+    std::lock_guard<std::mutex> write_lock(write_mutex);
+
+    std::string lines;
+    std::vector<FrecencyIndex::Entry> visits;
+    std::vector<std::string> pinned_paths;
+    uint64_t sequence = 0;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.flush_queued = false;
+        lines.swap(state.pending);
+        compact = compact || state.journal_entries + CountLines(lines) >= kCompactEntries;
+        if (!compact) {
+            if (lines.empty()) return true;
+        } else {
+            visits = state.frecency.Entries();
+            pinned_paths = state.pinned_paths;
+            sequence = state.next_sequence - 1;
         }
     }
+
+    auto restore = [&state, &lines]() {
+        // Keep the lines for the next write, ahead of anything newer
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.pending.insert(0, lines);
+        return false;
+    };
+
+    if (!compact) {
+        if (!AppendFile(state.journal_path, lines)) return restore();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.journal_entries += CountLines(lines);
+        return true;
+    }
+
+    if (state.save_path.empty()) return restore();
+    std::string text = "[Sequence]\n" + std::to_string(sequence) + "\n";
+    text += "[Pinned]\n";
+    for (const auto& path : pinned_paths) {
+        text += path + "\n";
+    }
+    // count|last visit|key|path; keys need every digit to keep the order
+    text += "[Frecency]\n";
+    char numbers[96];
+    for (const auto& entry : visits) {
+        std::snprintf(numbers, sizeof(numbers), "%d|%lld|%.17g|", entry.count,
+                      static_cast<long long>(entry.last_visit), entry.key);
+        text += numbers + entry.path + "\n";
+    }
+    if (!WriteFileReplacing(state.save_path, text)) return restore();
+
+    // The snapshot holds every entry up to sequence, so the journal can go.
+    // If this fails, loading skips the old entries by their sequence.
+    FILE* f = std::fopen(state.journal_path.c_str(), "wb");
+    if (!f) return false;
+    std::fclose(f);
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.journal_entries = 0;
+    return true;
 }
 
 void QuickAccess::Load() {
+    LoadState(state, scheduler);
+}
+
+void QuickAccess::LoadState(const std::shared_ptr<State>& shared, TaskScheduler& scheduler) {
+    StartupProfiler::Phase phase("quick_access.load");
+    // Read into a fresh state without the lock, then swap it in
+    int64_t now = NowSeconds();
+    State fresh;
+    State* state = &fresh;
+    auto& pinned_paths = state->pinned_paths;
+    const std::string& save_path = shared->save_path; // Both fixed at construction
+    const std::string& journal_path = shared->journal_path;
+
+    uint64_t snapshot_sequence = 0;
     std::ifstream in(save_path);
     if (in.is_open()) {
         std::string line;
-        bool reading_pinned = false;
-        bool reading_visits = false;
-        
+        enum { kNone, kSequence, kPinned, kFrecency, kVisits } section = kNone;
+
         while (std::getline(in, line)) {
-            if (line == "[Pinned]") {
-                reading_pinned = true;
-                reading_visits = false;
+            if (line == "[Sequence]") {
+                section = kSequence;
+                continue;
+            } else if (line == "[Pinned]") {
+                section = kPinned;
+                continue;
+            } else if (line == "[Frecency]") {
+                section = kFrecency;
                 continue;
             } else if (line == "[Visits]") {
-                reading_pinned = false;
-                reading_visits = true;
+                section = kVisits;
                 continue;
             }
-            
-            if (reading_pinned && !line.empty()) {
-                pinned_paths.push_back(line);
-            } else if (reading_visits && !line.empty()) {
+            if (line.empty()) continue;
+
+            if (section == kSequence) {
+                snapshot_sequence = std::strtoull(line.c_str(), nullptr, 10);
+            } else if (section == kPinned) {
+                ApplyLocked(*state, kPin, now, line);
+            } else if (section == kFrecency) {
+                FrecencyIndex::Entry entry;
+                long long last = 0;
+                int consumed = 0;
+                if (std::sscanf(line.c_str(), "%d|%lld|%lf|%n", &entry.count, &last, &entry.key, &consumed) < 3 ||
+                    consumed == 0 || !std::isfinite(entry.key)) {
+                    continue;
+                }
+                entry.last_visit = last;
+                entry.path = line.substr(consumed);
+                state->frecency.Set(entry);
+            } else if (section == kVisits) {
+                // Counts from before frecency, taken as that many visits now
                 size_t pipe = line.find('|');
                 if (pipe != std::string::npos) {
-                    std::string path = line.substr(0, pipe);
-                    int count = std::stoi(line.substr(pipe + 1));
-                    visit_counts[path] = count;
+                    FrecencyIndex::Entry entry;
+                    entry.path = line.substr(0, pipe);
+                    entry.count = std::max(1, std::atoi(line.c_str() + pipe + 1));
+                    entry.last_visit = now;
+                    entry.key = FrecencyIndex::VisitKey(now) + std::log(static_cast<double>(entry.count));
+                    state->frecency.Set(entry);
                 }
             }
         }
     }
+
+    // Replay what happened after the snapshot
+    uint64_t last_sequence = snapshot_sequence;
+    std::ifstream journal(journal_path, std::ios::binary);
+    if (journal.is_open()) {
+        std::string line;
+        std::streamoff complete = 0;
+        while (std::getline(journal, line)) {
+            if (journal.eof()) {
+                // A line cut short by a crash has no newline. Cut it off so
+                // the next append starts a line of its own.
+                journal.close();
+                std::error_code ec;
+                fs::resize_file(journal_path, static_cast<uintmax_t>(complete), ec);
+                break;
+            }
+            complete = journal.tellg();
+            state->journal_entries++;
+            unsigned long long sequence = 0;
+            char op = 0;
+            long long when = 0;
+            int consumed = 0;
+            if (std::sscanf(line.c_str(), "%llu|%c|%lld|%n", &sequence, &op, &when, &consumed) < 3 || consumed == 0) {
+                continue;
+            }
+            last_sequence = std::max<uint64_t>(last_sequence, sequence);
+            if (sequence <= snapshot_sequence) continue; // Already in the snapshot
+            ApplyLocked(*state, op, when, line.substr(consumed));
+        }
+    }
+    state->next_sequence = last_sequence + 1;
     
     // Seed defaults if empty
-    if (pinned_paths.empty() && visit_counts.empty()) {
+    if (pinned_paths.empty() && state->frecency.size() == 0) {
+#ifdef _WIN32
         pinned_paths.push_back(GetKnownFolderPath(&FOLDERID_Desktop));
         pinned_paths.push_back(GetKnownFolderPath(&FOLDERID_Documents));
         pinned_paths.push_back(GetKnownFolderPath(&FOLDERID_Downloads));
@@ -144,10 +368,35 @@ void QuickAccess::Load() {
         pinned_paths.push_back(GetKnownFolderPath(&FOLDERID_Pictures));
         pinned_paths.push_back(GetKnownFolderPath(&FOLDERID_Videos));
         pinned_paths.push_back("C:/");
+#else
+        if (const char* home = std::getenv("HOME")) pinned_paths.push_back(home);
+        pinned_paths.push_back("/");
+#endif
         
-        // Initialize counts for these so they aren't zero?
-        // Not strictly necessary if they are pinned.
+        state->pinned_set.insert(pinned_paths.begin(), pinned_paths.end());
+    }
+
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->frecency = std::move(fresh.frecency);
+        shared->pinned_paths = std::move(fresh.pinned_paths);
+        shared->pinned_set = std::move(fresh.pinned_set);
+        shared->next_sequence = fresh.next_sequence;
+        shared->journal_entries = fresh.journal_entries;
+        shared->pending.clear();
+        shared->loaded = true;
+        for (const auto& change : shared->early) {
+            if (ApplyLocked(*shared, change.first, change.second.first, change.second.second)) {
+                RecordLocked(*shared, change.first, change.second.first, change.second.second);
+                changed = true;
+            }
+        }
+        shared->early.clear();
     }
+    shared->loaded_cv.notify_all();
+    if (changed) QueueWrite(shared, scheduler);
+    Notify(*shared);
 }
 
 }
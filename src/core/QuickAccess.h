@@ -1,43 +1,108 @@
 #pragma once
+#include "TaskScheduler.h"
+#include "FrecencyIndex.h"
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_set>
+#include <memory>
 #include <functional>
 #include <mutex>
+#include <condition_variable>
+#include <cstdint>
 
 namespace core {
 
+// Pinned folders and frecently visited ones (see FrecencyIndex) for the sidebar.
+//
+// Persisted as a snapshot (quick_access.txt) plus an append-only journal
+// (quick_access.journal) of the visits, pins and unpins since. Changes only
+// touch memory; a write-behind task on the pool appends them to the journal,
+// and once the journal passes kCompactEntries it folds everything into a new
+// snapshot that replaces the old one (see WriteFileReplacing). Journal
+// entries carry sequence numbers and the snapshot records the last one it
+// holds, so a crash between the rename and truncating the journal does not
+// count a visit twice.
+//
+// Get() loads on the pool so startup doesn't wait for the files and the
+// known-folder lookups. Until then GetItems is empty and changes queue up;
+// the update callback runs once loading is done.
 class QuickAccess {
 public:
     struct Item {
         std::string path;
-        int score;
+        int score; // Visits
         bool pinned;
+        double frecency; // Decayed score now
+        int64_t last_visit; // Unix seconds, 0 if never
     };
 
     static QuickAccess& Get();
 
+    // save_path is the snapshot; the journal sits next to it. Loads before
+    // returning unless load_now is false.
+    explicit QuickAccess(const std::string& save_path, TaskScheduler& scheduler = TaskScheduler::Get(),
+                         bool load_now = true);
+    ~QuickAccess();
+
     void AddVisit(const std::string& path);
+    void AddVisit(const std::string& path, int64_t when);
+    // Pinned first, in pin order, then the most frecent; O(k log k) in limit
     std::vector<Item> GetItems(int limit = 10);
-    
+
     void Pin(const std::string& path);
     void Unpin(const std::string& path);
     bool IsPinned(const std::string& path);
-    
-    void Save();
+
+    // Writes a fresh snapshot and empties the journal, on the calling thread
+    bool Save();
+    // Rereads the files on the calling thread
     void Load();
-    
+    bool IsLoaded();
+    void WaitUntilLoaded();
+    // Appends pending changes to the journal, on the calling thread
+    bool Flush();
+
     void SetUpdateCallback(std::function<void()> cb);
 
+    static const size_t kCompactEntries = 512;
+
 private:
-    QuickAccess();
-    ~QuickAccess();
+    QuickAccess(const QuickAccess&) = delete;
+    QuickAccess& operator=(const QuickAccess&) = delete;
+
+    // Shared with the write-behind task
+    struct State {
+        std::mutex mutex;
+        std::string save_path;
+        std::string journal_path;
+        FrecencyIndex frecency;
+        std::vector<std::string> pinned_paths;
+        std::unordered_set<std::string> pinned_set;
+        uint64_t next_sequence = 1;
+        std::string pending; // Journal lines not yet written
+        size_t journal_entries = 0; // Lines in the file on disk
+        bool flush_queued = false;
+        bool loaded = false;
+        std::condition_variable loaded_cv;
+        std::vector<std::pair<char, std::pair<int64_t, std::string>>> early; // Changes made before loading
+
+        std::mutex callback_mutex;
+        std::function<void()> on_update;
+    };
+
+    // Callers hold state.mutex. False if the change changed nothing.
+    static bool ApplyLocked(State& state, char op, int64_t when, const std::string& path);
+    static void RecordLocked(State& state, char op, int64_t when, const std::string& path);
+    static bool WriteState(State& state, bool compact);
+    // Queues a write-behind unless one is pending
+    static void QueueWrite(const std::shared_ptr<State>& state, TaskScheduler& scheduler);
+    static void LoadState(const std::shared_ptr<State>& state, TaskScheduler& scheduler);
+    static void Notify(State& state);
+
+    void Changed(char op, int64_t when, const std::string& path);
 
-    std::map<std::string, int> visit_counts;
-    std::vector<std::string> pinned_paths;
-    std::mutex mutex;
-    std::string save_path;
-    std::function<void()> on_update;
+    std::shared_ptr<State> state;
+    TaskScheduler& scheduler;
 };
 
 }
@@ -0,0 +1,151 @@
+#include "Session.h"
+#include "ListingCodec.h"
+#include "FileSystem.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace core {
+
+// Keeps the mapping alive for tabs decoded later, possibly on the pool
+struct EncodedSessionListing {
+    std::shared_ptr<const MappedFile> file;
+    const uint8_t* begin = nullptr;
+    const uint8_t* end = nullptr;
+    uint32_t entry_count = 0;
+    bool has_order = false;
+};
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t tab_count;
+    int32_t active;
+};
+
+enum TabFlag : uint8_t {
+    kTabHasListing = 1 << 0,
+    kTabHasOrder   = 1 << 1,
+};
+
+struct TabHeader {
+    uint32_t path_length;
+    int32_t top_row;
+    uint8_t column;
+    uint8_t ascending;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t entry_count;
+    uint64_t listing_bytes; // Entries and order, so readers can skip them
+};
+
+const char kMagic[4] = {'F', 'X', 'S', 'N'};
+
+bool ReadTab(ByteReader& in, const std::shared_ptr<const MappedFile>& file, SessionTab& tab) {
+    TabHeader header;
+    const char* path;
+    if (!in.Get(header) || !in.Bytes(header.path_length, path)) return false;
+    tab.path.assign(path, header.path_length);
+    tab.top_row = std::max(header.top_row, 0);
+    if (header.column > static_cast<uint8_t>(SortColumn::Date)) return false;
+    tab.sort.column = static_cast<SortColumn>(header.column);
+    tab.sort.ascending = header.ascending != 0;
+    if (!(header.flags & kTabHasListing)) return true;
+    if (header.entry_count > kMaxSessionEntries) return false;
+
+    const char* bytes;
+    if (header.listing_bytes > in.Left() || !in.Bytes(header.listing_bytes, bytes)) return false;
+    auto encoded = std::make_shared<EncodedSessionListing>();
+    encoded->file = file;
+    encoded->begin = reinterpret_cast<const uint8_t*>(bytes);
+    encoded->end = encoded->begin + header.listing_bytes;
+    encoded->entry_count = header.entry_count;
+    encoded->has_order = (header.flags & kTabHasOrder) != 0;
+    tab.encoded = std::move(encoded);
+    return true;
+}
+
+}
+
+bool DecodeSessionTab(SessionTab& tab) {
+    std::shared_ptr<const EncodedSessionListing> encoded = std::move(tab.encoded);
+    if (!encoded) return true;
+
+    // Keys are taken as written; icon ids belong to the run that wrote them
+    ByteReader in{encoded->begin, encoded->end};
+    auto listing = std::make_shared<Listing>(tab.path);
+    if (!DecodeListingEntries(in, encoded->entry_count, false, *listing)) return false;
+    std::shared_ptr<std::vector<uint32_t>> order;
+    if (encoded->has_order) {
+        order = std::make_shared<std::vector<uint32_t>>();
+        if (!DecodeListingOrder(in, encoded->entry_count, *order)) return false;
+    }
+    tab.listing = std::move(listing);
+    tab.order = std::move(order);
+    return true;
+}
+
+bool SaveSession(const std::string& path, const Session& session) {
+    std::string data;
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kSessionVersion;
+    header.tab_count = static_cast<uint32_t>(session.tabs.size());
+    header.active = session.active;
+    AppendRaw(data, header);
+
+    for (const SessionTab& tab : session.tabs) {
+        const Listing* listing = tab.listing.get();
+        if (listing && listing->size() > kMaxSessionEntries) listing = nullptr;
+        bool has_order = listing && tab.order && tab.order->size() == listing->size();
+
+        TabHeader tab_header = {};
+        tab_header.path_length = static_cast<uint32_t>(tab.path.size());
+        tab_header.top_row = tab.top_row;
+        tab_header.column = static_cast<uint8_t>(tab.sort.column);
+        tab_header.ascending = tab.sort.ascending ? 1 : 0;
+        tab_header.flags = static_cast<uint8_t>((listing ? kTabHasListing : 0) | (has_order ? kTabHasOrder : 0));
+        tab_header.reserved = 0;
+        tab_header.entry_count = listing ? static_cast<uint32_t>(listing->size()) : 0;
+        size_t header_at = data.size();
+        AppendRaw(data, tab_header);
+        data += tab.path;
+        if (!listing) continue;
+
+        size_t listing_at = data.size();
+        EncodeListingEntries(*listing, data);
+        if (has_order) EncodeListingOrder(*tab.order, data);
+        tab_header.listing_bytes = data.size() - listing_at;
+        std::memcpy(&data[header_at], &tab_header, sizeof(tab_header));
+    }
+
+    return WriteFileReplacing(path, data);
+}
+
+bool LoadSession(const std::string& path, Session& out) {
+    out = Session();
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path)) return false;
+
+    ByteReader in{file->data(), file->data() + file->size()};
+    FileHeader header;
+    if (!in.Get(header)) return false;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kSessionVersion) return false;
+
+    Session session;
+    for (uint32_t i = 0; i < header.tab_count; ++i) {
+        SessionTab tab;
+        if (!ReadTab(in, file, tab)) return false;
+        session.tabs.push_back(std::move(tab));
+    }
+    if (session.tabs.empty()) return false;
+    session.active = header.active >= 0 && header.active < static_cast<int>(session.tabs.size()) ? header.active : 0;
+    // The one tab painted first; a damaged listing just loads from disk
+    DecodeSessionTab(session.tabs[session.active]);
+    out = std::move(session);
+    return true;
+}
+
+}
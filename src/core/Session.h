@@ -0,0 +1,51 @@
+#pragma once
+#include "Listing.h"
+#include "ListingSort.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace core {
+
+// A tab's listing still in the mapped session file
+struct EncodedSessionListing;
+
+// One open tab as it was left
+struct SessionTab {
+    std::string path;
+    SortSpec sort;
+    int top_row = 0;
+    // What the tab showed; null if it was still loading or too large to keep
+    std::shared_ptr<const Listing> listing;
+    // Display order over listing for sort; null to sort on restore
+    std::shared_ptr<const std::vector<uint32_t>> order;
+    // Set instead of listing and order until DecodeSessionTab
+    std::shared_ptr<const EncodedSessionListing> encoded;
+};
+
+// Open tabs from the last run, so a launch can paint them before any
+// folder is read again. Restored listings are revalidated like any other
+// cached listing (see RestoreTab).
+struct Session {
+    std::vector<SessionTab> tabs;
+    int active = 0; // Index into tabs
+};
+
+// File: header, then per tab a tab header, the path and, if it kept a
+// listing, its entries and display order as ListingCodec.h writes them.
+// A bad magic or version reads as no session.
+bool SaveSession(const std::string& path, const Session& session);
+// False if there is no usable session; out is then empty. Only the active
+// tab's listing is decoded here; the others stay encoded, so startup does
+// not pay for tabs nobody is looking at.
+bool LoadSession(const std::string& path, Session& out);
+// Fills listing and order from encoded and clears it; any thread. False if
+// that part of the file is damaged, leaving the tab without a listing.
+bool DecodeSessionTab(SessionTab& tab);
+
+// Listings with more entries are not kept; those tabs load from disk
+const size_t kMaxSessionEntries = 100000;
+const uint32_t kSessionVersion = 2;
+
+}
@@ -0,0 +1,122 @@
+#include "SortKey.h"
+#include <cstdint>
+
+namespace core {
+
+namespace {
+
+// Digit runs are emitted as marker, significant digit count, digits.
+// The marker sorts below every printable character, so numbers come
+// before letters, and a shorter run (smaller value) before a longer one.
+const char kNumberMarker = '\x01';
+
+uint32_t FoldCase(uint32_t cp) {
+    if (cp < 0x80) {
+        return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    }
+    // Latin-1 Supplement (except the multiplication sign)
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;
+    // Latin Extended-A: mostly upper/lower pairs on even/odd code points
+    if (cp >= 0x100 && cp <= 0x17F) {
+        if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E)) {
+            return (cp & 1) ? cp + 1 : cp;
+        }
+        if (cp == 0x130 || cp == 0x131 || cp == 0x138 || cp == 0x149 || cp == 0x17F) return cp;
+        if (cp == 0x178) return 0xFF;
+        return (cp & 1) ? cp : cp + 1;
+    }
+    // Greek capitals (U+03A2 is unassigned)
+    if (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2) return cp + 0x20;
+    // Cyrillic
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    return cp;
+}
+
+void AppendUtf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out.push_back((char)cp);
+    } else if (cp < 0x800) {
+        out.push_back((char)(0xC0 | (cp >> 6)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back((char)(0xE0 | (cp >> 12)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back((char)(0xF0 | (cp >> 18)));
+        out.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Decodes one code point at s[i]; returns its length or 0 if malformed
+size_t DecodeUtf8(std::string_view s, size_t i, uint32_t& cp) {
+    unsigned char c = (unsigned char)s[i];
+    size_t len;
+    if (c < 0x80) { cp = c; return 1; }
+    else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; len = 2; }
+    else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; len = 3; }
+    else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; len = 4; }
+    else return 0;
+
+    if (i + len > s.size()) return 0;
+    for (size_t k = 1; k < len; ++k) {
+        unsigned char cc = (unsigned char)s[i + k];
+        if ((cc & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (cc & 0x3F);
+    }
+    return len;
+}
+
+}
+
+void AppendCollationKey(std::string_view name, std::string& out) {
+    size_t i = 0;
+    while (i < name.size()) {
+        unsigned char c = (unsigned char)name[i];
+
+        if (c >= '0' && c <= '9') {
+            size_t start = i;
+            while (i < name.size() && name[i] >= '0' && name[i] <= '9') ++i;
+            // Leading zeros do not change the value ("007" == "7")
+            size_t first = start;
+            while (first + 1 < i && name[first] == '0') ++first;
+            size_t digits = i - first;
+            if (digits > 255) {
+                // Absurdly long runs: clamp the count, keep every digit
+                digits = 255;
+            }
+            out.push_back(kNumberMarker);
+            out.push_back((char)digits);
+            out.append(name.data() + first, i - first);
+            continue;
+        }
+
+        if (c < 0x80) {
+            out.push_back((char)((c >= 'A' && c <= 'Z') ? c + 0x20 : c));
+            ++i;
+            continue;
+        }
+
+        uint32_t cp;
+        size_t len = DecodeUtf8(name, i, cp);
+        if (len == 0) {
+            out.push_back((char)c);
+            ++i;
+            continue;
+        }
+        AppendUtf8(FoldCase(cp), out);
+        i += len;
+    }
+}
+
+std::string CollationKey(std::string_view name) {
+    std::string key;
+    key.reserve(name.size() + 4);
+    AppendCollationKey(name, key);
+    return key;
+}
+
+}
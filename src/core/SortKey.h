@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace core {
+
+// Collation keys for file names. A key is built once per entry and then
+// compared bytewise (memcmp), which gives:
+//  - Unicode simple case folding for Latin, Greek and Cyrillic letters
+//  - natural number order: runs of digits compare by value, so "file9"
+//    sorts before "file10"
+// Bytes that are not valid UTF-8 are kept as they are.
+void AppendCollationKey(std::string_view name, std::string& out);
+std::string CollationKey(std::string_view name);
+
+// Bytewise order with the shorter key first on a shared prefix
+inline int CompareKeys(std::string_view a, std::string_view b) {
+    return a.compare(b);
+}
+
+}
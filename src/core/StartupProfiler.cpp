@@ -0,0 +1,102 @@
+#include "StartupProfiler.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace core {
+
+namespace {
+
+double Millis(StartupProfiler::Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+}
+
+StartupProfiler& StartupProfiler::Get() {
+    static StartupProfiler instance;
+    return instance;
+}
+
+void StartupProfiler::Begin(Clock::time_point start) {
+    std::lock_guard<std::mutex> lock(mutex);
+    begin = start;
+    ui_thread = std::this_thread::get_id();
+}
+
+void StartupProfiler::Record(const char* name, Clock::time_point start, Clock::time_point end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished) return; // Late phases would be missing from the report anyway
+    entries.push_back({name, start, end, std::this_thread::get_id() == ui_thread});
+}
+
+void StartupProfiler::Mark(const char* name) {
+    Clock::time_point now = Clock::now();
+    Record(name, now, now);
+}
+
+bool StartupProfiler::Finished() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished;
+}
+
+std::string StartupProfiler::Report() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Entry> sorted = entries;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Entry& a, const Entry& b) { return a.start < b.start; });
+
+    Clock::time_point last = begin;
+    for (const Entry& e : sorted) last = std::max(last, e.end);
+    double total = Millis(last - begin);
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "Startup took %.1f ms (target %d ms)\n", total, kTargetMs);
+    std::string out = line;
+    for (const Entry& e : sorted) {
+        if (e.start == e.end) {
+            std::snprintf(line, sizeof(line), "  %-22s at %7.1f ms\n", e.name, Millis(e.start - begin));
+        } else {
+            std::snprintf(line, sizeof(line), "  %-22s %7.1f - %7.1f ms  %6.1f ms%s\n", e.name,
+                          Millis(e.start - begin), Millis(e.end - begin), Millis(e.end - e.start),
+                          e.ui_thread ? "" : "  (background)");
+        }
+        out += line;
+    }
+    return out;
+}
+
+bool StartupProfiler::Finish() {
+    std::string report = Report();
+    std::vector<Entry> done;
+    Clock::time_point start;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finished) return false;
+        finished = true;
+        done = entries;
+        start = begin;
+    }
+    Clock::time_point last = start;
+    for (const Entry& e : done) last = std::max(last, e.end);
+    if (!report.empty() && report.back() == '\n') report.pop_back();
+    if (last - start > std::chrono::milliseconds(kTargetMs)) LOG_WARN(report);
+    else LOG_INFO(report);
+
+    // Startup phases predate the tracer's clock; place them by their offset from now
+    Tracer& tracer = Tracer::Get();
+    if (tracer.Enabled()) {
+        int64_t now_ns = tracer.Now();
+        Clock::time_point now = Clock::now();
+        for (const Entry& e : done) {
+            auto at = [&](Clock::time_point t) {
+                return std::max<int64_t>(0, now_ns - std::chrono::duration_cast<std::chrono::nanoseconds>(now - t).count());
+            };
+            tracer.Record(e.name, "startup", at(e.start), at(e.end));
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+namespace core {
+
+// Per-phase timing of a cold start, from the first line of main to the
+// first painted listing. Phases may run on any thread and overlap; Finish
+// logs the breakdown once and hands each phase to the Tracer as a span.
+class StartupProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static StartupProfiler& Get();
+
+    // The process start; phases are reported relative to it. The calling
+    // thread is the UI thread in the report.
+    void Begin(Clock::time_point start);
+
+    // Times its own lifetime as a phase
+    class Phase {
+    public:
+        explicit Phase(const char* name) : name(name), start(Clock::now()) {}
+        ~Phase() { StartupProfiler::Get().Record(name, start, Clock::now()); }
+
+    private:
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+        const char* name;
+        Clock::time_point start;
+    };
+
+    // name must outlive the profiler (string literals)
+    void Record(const char* name, Clock::time_point start, Clock::time_point end);
+    // A point in time, such as the first frame
+    void Mark(const char* name);
+
+    // Logs the report the first time; true if this call did
+    bool Finish();
+    bool Finished();
+    std::string Report();
+
+    static constexpr int kTargetMs = 100;
+
+private:
+    struct Entry {
+        const char* name;
+        Clock::time_point start;
+        Clock::time_point end;
+        bool ui_thread;
+    };
+
+    std::mutex mutex;
+    Clock::time_point begin = Clock::now();
+    std::thread::id ui_thread;
+    std::vector<Entry> entries;
+    bool finished = false;
+};
+
+}
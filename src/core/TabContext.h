@@ -1,26 +1,58 @@
 #pragma once
-#include "FileEntry.h"
+#include "ListingSnapshot.h"
+#include "ListingSort.h"
+#include "DirectoryWatcher.h"
+#include "UpdateChannel.h"
 #include <vector>
 #include <string>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
 
 namespace core {
 
 struct TabContext {
-    std::vector<FileEntry> files;
+    // Current listing. Any thread may read it with Snapshot() without
+    // locking; writers hold mutex while they build a replacement and
+    // Publish() it, so the UI never waits for them.
+    std::shared_ptr<const ListingSnapshot> Snapshot() const { return std::atomic_load(&published); }
+    void Publish(std::shared_ptr<const ListingSnapshot> next) { std::atomic_store(&published, std::move(next)); }
+    // Only accessed through Snapshot() and Publish()
+    std::shared_ptr<const ListingSnapshot> published = std::make_shared<ListingSnapshot>();
+
+    SortSpec sort;
+
     std::string current_path;
     std::mutex mutex;
     std::atomic<bool> is_loading{false};
-    std::string status_text = "Ready";
+    // Bumped by every StartLoading; workers holding an older value are stale
+    std::atomic<uint64_t> generation{0};
+    // Whether the owning tab is visible; picks the scheduler priority for loads
+    std::atomic<bool> is_active{true};
+    std::string status_text = "Ready"; // Guarded by mutex
+
+    // Hibernation (see HibernateTab), guarded by mutex: the file holding the
+    // spilled listing, empty while it is in memory, and the folder's change
+    // stamp when it was written
+    std::string hibernation_file;
+    int64_t hibernation_stamp = 0;
+    bool hibernation_queued = false;
     
-    // Callback to notify UI of updates (called from worker thread)
+    // Dirty flags for the UI; see NotifyUI in FileSystem.cpp
+    UpdateChannel updates;
+    // Runs on the UI thread when updates went from empty to pending
     std::function<void()> on_update;
 
     // History
     std::vector<std::string> history_back;
     std::vector<std::string> history_forward;
+
+    // Watches current_path while it is shown (guarded by mutex, but stopped
+    // outside it). Declared last so it is destroyed, and its thread joined,
+    // before anything it touches.
+    std::unique_ptr<DirectoryWatcher> watcher;
 };
 
 }
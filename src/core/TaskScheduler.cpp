@@ -0,0 +1,116 @@
+#include "TaskScheduler.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+#ifdef _WIN32
+#include <objbase.h>
+#endif
+
+namespace core {
+
+TaskScheduler& TaskScheduler::Get() {
+    static TaskScheduler instance(std::max<size_t>(2, std::thread::hardware_concurrency()));
+    return instance;
+}
+
+// At least two workers so the visible-work reservation always holds one
+TaskScheduler::TaskScheduler(size_t count) : worker_count(std::max<size_t>(2, count)) {
+    workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&TaskScheduler::WorkerLoop, this);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    Shutdown();
+}
+
+void TaskScheduler::Submit(TaskPriority priority, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+        queues[static_cast<int>(priority)].push_back(std::move(task));
+    }
+    cv.notify_all();
+}
+
+void TaskScheduler::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping && workers.empty()) return;
+        stopping = true;
+        for (auto& queue : queues) queue.clear();
+    }
+    cv.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+}
+
+// Called with the mutex held
+bool TaskScheduler::PopTask(std::function<void()>& task, bool& background) {
+    auto& visible = queues[static_cast<int>(TaskPriority::ActiveTab)];
+    if (!visible.empty()) {
+        task = std::move(visible.front());
+        visible.pop_front();
+        background = false;
+        return true;
+    }
+
+    if (background_running + 1 >= worker_count) return false;
+
+    for (int p = static_cast<int>(TaskPriority::BackgroundTab); p < static_cast<int>(TaskPriority::Count); ++p) {
+        if (!queues[p].empty()) {
+            task = std::move(queues[p].front());
+            queues[p].pop_front();
+            background = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::WorkerLoop() {
+#ifdef _WIN32
+    // Shell icon and known-folder calls need COM on the calling thread
+    CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+#endif
+
+    Tracer::Get().NameThread("Pool worker");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        std::function<void()> task;
+        bool background = false;
+        cv.wait(lock, [&]() { return stopping || PopTask(task, background); });
+        if (!task) break; // stopping with nothing claimed
+
+        if (background) background_running++;
+        lock.unlock();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Task failed: " + std::string(e.what()));
+        } catch (...) {
+            LOG_ERROR("Task failed with unknown error");
+        }
+
+        lock.lock();
+        if (background) {
+            background_running--;
+            // A background slot freed up, another worker may now take one
+            cv.notify_all();
+        }
+    }
+    lock.unlock();
+
+#ifdef _WIN32
+    CoUninitialize();
+#endif
+}
+
+}
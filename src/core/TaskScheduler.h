@@ -0,0 +1,58 @@
+#pragma once
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+namespace core {
+
+// Lower value runs first
+enum class TaskPriority {
+    ActiveTab = 0,
+    BackgroundTab,
+    Prefetch,
+    Indexing,
+    Count
+};
+
+// Fixed pool of I/O workers shared by the whole app.
+// Anything below ActiveTab may occupy at most (workers - 1) threads, so work
+// for the visible tab never waits behind background work.
+class TaskScheduler {
+public:
+    static TaskScheduler& Get();
+
+    explicit TaskScheduler(size_t worker_count);
+    ~TaskScheduler();
+
+    void Submit(TaskPriority priority, std::function<void()> task);
+
+    // Drops queued tasks and joins the workers. Running tasks should poll
+    // IsStopping() to finish early. Safe to call more than once.
+    void Shutdown();
+    bool IsStopping() const { return stopping; }
+
+    size_t WorkerCount() const { return worker_count; }
+
+private:
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void WorkerLoop();
+    bool PopTask(std::function<void()>& task, bool& background);
+
+    // Fixed before any worker starts, so workers read it without the mutex
+    const size_t worker_count;
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queues[static_cast<int>(TaskPriority::Count)];
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> stopping{false};
+    size_t background_running = 0;
+};
+
+}
@@ -0,0 +1,179 @@
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace core {
+
+namespace {
+
+std::atomic<uint64_t> g_next_tracer_id{1};
+
+void AppendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// Trace-event timestamps are microseconds
+void AppendMicros(std::string& out, int64_t ns) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%lld.%03d", static_cast<long long>(ns / 1000), static_cast<int>(ns % 1000));
+    out += number;
+}
+
+}
+
+Tracer& Tracer::Get() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer() : epoch(std::chrono::steady_clock::now()), id(g_next_tracer_id.fetch_add(1)) {}
+
+Tracer::ThreadBuffer* Tracer::CurrentBuffer() {
+    // The registry keeps the buffer past the thread's exit until the next
+    // export or clear
+    struct Cache {
+        uint64_t owner = 0;
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+    thread_local Cache cache;
+    if (cache.owner != id) {
+        cache.buffer = std::make_shared<ThreadBuffer>();
+        cache.owner = id;
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        cache.buffer->tid = next_tid++;
+        buffers.push_back(cache.buffer);
+    }
+    return cache.buffer.get();
+}
+
+void Tracer::NameThread(const std::string& name) {
+    ThreadBuffer* buffer = CurrentBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->name = name;
+}
+
+void Tracer::Record(const char* name, const char* category, int64_t start_ns, int64_t end_ns, std::string detail) {
+    ThreadBuffer* buffer = CurrentBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    Event event{name, category, start_ns, end_ns, std::move(detail)};
+    if (buffer->events.size() < kMaxEventsPerThread) {
+        buffer->events.push_back(std::move(event));
+    } else {
+        buffer->events[buffer->next] = std::move(event);
+        buffer->next = (buffer->next + 1) % kMaxEventsPerThread;
+    }
+}
+
+bool Tracer::ExportChromeJson(const std::string& path) {
+    std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        snapshot = buffers;
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+    std::vector<ThreadBuffer*> exited;
+    for (const auto& buffer : snapshot) {
+        // Two owners left (the registry and this snapshot) means the thread is gone
+        if (buffer.use_count() <= 2) exited.push_back(buffer.get());
+        // Copy out so the thread is held up no longer than that
+        std::vector<Event> events;
+        std::string thread_name;
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            events.reserve(buffer->events.size());
+            for (size_t i = 0; i < buffer->events.size(); ++i) {
+                events.push_back(buffer->events[(buffer->next + i) % buffer->events.size()]);
+            }
+            thread_name = buffer->name;
+        }
+        std::string tid = std::to_string(buffer->tid);
+
+        if (!thread_name.empty()) {
+            separator();
+            out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":";
+            AppendJsonString(out, thread_name);
+            out += "}}";
+        }
+        for (const Event& e : events) {
+            separator();
+            out += "{\"ph\":\"X\",\"pid\":1,\"tid\":" + tid + ",\"name\":";
+            AppendJsonString(out, e.name);
+            out += ",\"cat\":";
+            AppendJsonString(out, e.category);
+            out += ",\"ts\":";
+            AppendMicros(out, e.start_ns);
+            out += ",\"dur\":";
+            AppendMicros(out, e.end_ns - e.start_ns);
+            if (!e.detail.empty()) {
+                out += ",\"args\":{\"detail\":";
+                AppendJsonString(out, e.detail);
+                out += "}";
+            }
+            out += "}";
+        }
+    }
+    out += "\n]}\n";
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    ok = std::fclose(f) == 0 && ok;
+
+    // Exited threads' spans are kept for a retry until a write succeeds
+    if (ok && !exited.empty()) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [&](const std::shared_ptr<ThreadBuffer>& b) {
+            return std::find(exited.begin(), exited.end(), b.get()) != exited.end();
+        }), buffers.end());
+    }
+    return ok;
+}
+
+void Tracer::Clear() {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    // Only the registry still holds the buffer of a thread that has exited
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const std::shared_ptr<ThreadBuffer>& b) {
+        return b.use_count() == 1;
+    }), buffers.end());
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+        buffer->next = 0;
+    }
+}
+
+size_t Tracer::EventCount() {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    size_t count = 0;
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        count += buffer->events.size();
+    }
+    return count;
+}
+
+}
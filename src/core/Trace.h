@@ -0,0 +1,120 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace core {
+
+// Timed spans along the navigation path, for chrome://tracing or Perfetto.
+// Each thread records into its own buffer, a ring that keeps the newest
+// kMaxEventsPerThread spans; its lock is only contended while exporting.
+// Off by default: a span then costs one relaxed load.
+class Tracer {
+public:
+    static Tracer& Get();
+
+    Tracer();
+
+    void SetEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Shown for the calling thread in the viewer
+    void NameThread(const std::string& name);
+
+    // name and category must outlive the tracer (string literals)
+    void Record(const char* name, const char* category, int64_t start_ns, int64_t end_ns,
+                std::string detail = std::string());
+
+    // Writes every buffered span as trace-event JSON; false if the file
+    // cannot be written. Recording carries on meanwhile.
+    // Export and Clear also drop the buffers of threads that have exited.
+    bool ExportChromeJson(const std::string& path);
+    void Clear();
+    size_t EventCount();
+
+    // Nanoseconds since the tracer was created
+    int64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    static constexpr size_t kMaxEventsPerThread = 1 << 16;
+
+private:
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    struct Event {
+        const char* name;
+        const char* category;
+        int64_t start_ns;
+        int64_t end_ns;
+        std::string detail;
+    };
+
+    struct ThreadBuffer {
+        std::mutex mutex;
+        uint32_t tid = 0;
+        std::string name;
+        std::vector<Event> events; // Ring once full
+        size_t next = 0; // Oldest event once full
+    };
+
+    ThreadBuffer* CurrentBuffer();
+
+    std::atomic<bool> enabled{false};
+    const std::chrono::steady_clock::time_point epoch;
+    const uint64_t id; // Tells tracers apart in the thread-local buffer cache
+
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint32_t next_tid = 1; // Not reused, so pruned threads keep their own track
+};
+
+// Records the time from construction to destruction as one span
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "app")
+        : name(name), category(category), start(Tracer::Get().Enabled() ? Tracer::Get().Now() : -1) {}
+    TraceSpan(const char* name, const char* category, std::string detail)
+        : TraceSpan(name, category) {
+        if (start >= 0) this->detail = std::move(detail);
+    }
+    ~TraceSpan() {
+        if (start >= 0) Tracer::Get().Record(name, category, start, Tracer::Get().Now(), std::move(detail));
+    }
+
+private:
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    const char* name;
+    const char* category;
+    int64_t start; // -1 when tracing was off
+    std::string detail;
+};
+
+}
+
+// Spans compile out entirely with FLASH_TRACE=0
+#ifndef FLASH_TRACE
+#define FLASH_TRACE 1
+#endif
+
+#define FLASH_TRACE_CONCAT_(a, b) a##b
+#define FLASH_TRACE_CONCAT(a, b) FLASH_TRACE_CONCAT_(a, b)
+
+#if FLASH_TRACE
+#define TRACE_SPAN(name, category) ::core::TraceSpan FLASH_TRACE_CONCAT(trace_span_, __LINE__)(name, category)
+// detail is only evaluated while tracing
+#define TRACE_SPAN_DETAIL(name, category, detail)                                                   \
+    ::core::TraceSpan FLASH_TRACE_CONCAT(trace_span_, __LINE__)(                                    \
+        name, category, ::core::Tracer::Get().Enabled() ? std::string(detail) : std::string())
+#else
+#define TRACE_SPAN(name, category) do {} while (0)
+#define TRACE_SPAN_DETAIL(name, category, detail) do {} while (0)
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace core {
+
+// What a worker changed, so the UI repaints only that
+enum UpdateFlags : uint32_t {
+    kUpdateRows = 1 << 0,     // A new listing snapshot was published
+    kUpdateStatus = 1 << 1,   // status_text
+    kUpdateLocation = 1 << 2, // current_path (address bar, tab label and icon)
+    kUpdateState = 1 << 3,    // is_loading flipped
+    kUpdateAll = 0xFFFFFFFFu
+};
+
+// Worker -> UI notifications for one tab. Posts only OR flags into a word;
+// the first post after a drain returns true and is the only one that needs
+// to wake the UI, so a load posting every batch costs one wakeup per drain
+// and the UI decides how often to drain.
+class UpdateChannel {
+public:
+    // Any thread
+    bool Post(uint32_t flags) {
+        posted.fetch_add(1, std::memory_order_relaxed);
+        return pending.fetch_or(flags, std::memory_order_acq_rel) == 0;
+    }
+
+    // UI thread: everything posted since the last drain
+    uint32_t Take() {
+        uint32_t flags = pending.exchange(0, std::memory_order_acq_rel);
+        if (flags) drained.fetch_add(1, std::memory_order_relaxed);
+        return flags;
+    }
+
+    bool HasPending() const { return pending.load(std::memory_order_acquire) != 0; }
+
+    // Posts against drains: how much coalescing is saving
+    uint64_t PostCount() const { return posted.load(std::memory_order_relaxed); }
+    uint64_t DrainCount() const { return drained.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> pending{0};
+    std::atomic<uint64_t> posted{0};
+    std::atomic<uint64_t> drained{0};
+};
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+#if defined(_WIN32)
+#include <windows.h>
+#include <string>
+
+namespace core {
+
+// UTF-8 to UTF-16 for the W-suffixed Win32 calls
+inline std::wstring ToWide(const std::string& s) {
+    if (s.empty()) return std::wstring();
+    int size_needed = MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), NULL, 0);
+    std::wstring ws(size_needed, 0);
+    MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), &ws[0], size_needed);
+    return ws;
+}
+
+// UTF-16 to UTF-8 into out, so a loop over names can reuse its capacity
+inline void ToUtf8(const wchar_t* ws, int len, std::string& out) {
+    if (len <= 0) {
+        out.clear();
+        return;
+    }
+    int size_needed = WideCharToMultiByte(CP_UTF8, 0, ws, len, NULL, 0, NULL, NULL);
+    out.resize(size_needed);
+    WideCharToMultiByte(CP_UTF8, 0, ws, len, &out[0], size_needed, NULL, NULL);
+}
+
+inline std::string ToUtf8(const wchar_t* ws, int len) {
+    std::string out;
+    ToUtf8(ws, len, out);
+    return out;
+}
+
+}
+#endif
@@ -1,27 +1,60 @@
 #include "ui/ExplorerWindow.h"
 #include "core/FileSystem.h"
 #include "core/Logger.h"
+#include "core/TaskScheduler.h"
+#include "core/Trace.h"
+#include "core/Metrics.h"
+#include "core/StartupProfiler.h"
+#include "core/IconDiskCache.h"
+#include "core/QuickAccess.h"
 #include <FL/Fl.H>
 #include <chrono>
 #include <string>
+#include <cstdlib>
+#include <cstring>
 #include <windows.h> // For CoInitialize
 
 int main(int argc, char** argv) {
     // Capture start time
     auto start_time = std::chrono::steady_clock::now();
+    core::StartupProfiler::Get().Begin(start_time);
 
-    // Initialize COM for Shell APIs
-    HRESULT hr = CoInitialize(NULL);
-    
-    // Set DPI awareness
-    SetProcessDPIAware();
+    // FLASH_TRACE=1 or --trace records navigation spans; F12 or exit writes trace.json
+    bool trace = std::getenv("FLASH_TRACE") != nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0) trace = true;
+    }
+    core::Tracer::Get().SetEnabled(trace);
+    core::Tracer::Get().NameThread("UI");
 
-    Fl::lock();
+    HRESULT hr;
+    {
+        core::StartupProfiler::Phase phase("platform");
+        // Initialize COM for Shell APIs
+        hr = CoInitialize(NULL);
+        // Set DPI awareness
+        SetProcessDPIAware();
+        Fl::lock();
+    }
 
-    // Initialize Logger
-    std::string logPath = core::GetConfigDir() + "\\flash_log.txt";
-    core::Init(logPath);
-    core::Log("Application started.");
+    // Nothing here is needed for the first frame, so it runs on the pool
+    // while the window is built. Whatever the window needs first (the config
+    // dir, the Quick Access list) waits for it or fills in later.
+    {
+        core::StartupProfiler::Phase phase("pool");
+        core::TaskScheduler& pool = core::TaskScheduler::Get();
+        pool.Submit(core::TaskPriority::ActiveTab, []() {
+            core::StartupProfiler::Phase phase("logger");
+            core::Logger::Get().Open(core::GetConfigDir() + "\\flash_log.txt");
+            LOG_INFO("Application started.");
+        });
+        // Loads itself on the pool
+        core::QuickAccess::Get();
+        pool.Submit(core::TaskPriority::Prefetch, []() {
+            core::StartupProfiler::Phase phase("icon_cache.map");
+            core::IconDiskCache::Get().Load();
+        });
+    }
 
     // Modernize UI
     // Fl::scheme("gtk+"); // Removed to allow custom scrollbar styling
@@ -36,9 +69,21 @@ int main(int argc, char** argv) {
     Fl::scrollbar_size(8); // Thinner (8px)
 
     ui::ExplorerWindow window(1000, 700, "Flash Explorer", start_time);
-    window.show();
+    {
+        core::StartupProfiler::Phase phase("window.show");
+        window.show();
+    }
 
     int result = Fl::run();
+
+    // While the logger can still report a failed save
+    window.SaveSession();
+    // Join the I/O pool before the window (and the tab contexts) go away
+    core::TaskScheduler::Get().Shutdown();
+    window.RemoveHibernatedListings();
+    if (trace) core::Tracer::Get().ExportChromeJson(core::GetConfigDir() + "/trace.json");
+    core::Metrics::Get().DumpTo(core::GetConfigDir() + "/metrics.txt");
+    core::Logger::Get().Close();
     
     CoUninitialize();
     return result;
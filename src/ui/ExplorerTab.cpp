@@ -1,8 +1,10 @@
 #include "ExplorerTab.h"
 #include "../core/FileSystem.h"
+#include "../core/Trace.h"
 #include "IconManager.h"
 #include <FL/Fl.H>
 #include <FL/Fl_RGB_Image.H>
+#include <cstdio>
 
 namespace ui {
 
@@ -11,8 +13,7 @@ ExplorerTab::ExplorerTab(int x, int y, int w, int h)
     
     context = std::make_shared<core::TabContext>();
     context->on_update = [this]() {
-        this->Refresh();
-        if (this->on_state_changed) this->on_state_changed();
+        this->ScheduleDrain();
     };
 
     // File Table (Full space)
@@ -30,32 +31,124 @@ ExplorerTab::ExplorerTab(int x, int y, int w, int h)
 }
 
 ExplorerTab::~ExplorerTab() {
-    // Context will be destroyed when shared_ptr goes out of scope
+    // Context will be destroyed when shared_ptr goes out of scope.
+    // Supersede any queued or running load so it stops touching the context.
+    context->generation++;
+    core::StopWatching(context);
+    std::string spilled;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        spilled = context->hibernation_file;
+    }
+    if (!spilled.empty()) std::remove(spilled.c_str());
+    IconManager::Get().CancelSpecificIcons(this);
+    Fl::remove_timeout(DrainTimeout, this);
 }
 
 void ExplorerTab::Navigate(const char* path) {
     core::StartLoading(path, context);
 }
 
-void ExplorerTab::Refresh() {
+void ExplorerTab::Reload() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        path = context->current_path;
+    }
+    if (!path.empty()) core::StartLoading(path, context, false);
+}
+
+void ExplorerTab::Restore(const core::SessionTab& saved) {
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        context->sort = saved.sort;
+    }
+    file_table->ShowSort(saved.sort);
+    FileTable::ViewState view;
+    view.top_row = saved.top_row;
+    file_table->RestoreView(std::move(view));
+    core::RestoreTab(saved, context);
+}
+
+void ExplorerTab::Hibernate(const std::string& file) {
+    hibernated_view = file_table->SaveView();
+    core::HibernateTab(context, file);
+}
+
+void ExplorerTab::Wake() {
+    if (core::WakeTab(context)) file_table->RestoreView(std::move(hibernated_view));
+}
+
+bool ExplorerTab::Hibernating() {
     std::lock_guard<std::mutex> lock(context->mutex);
-    
-    file_table->rows((int)context->files.size());
-    file_table->redraw();
-    
-    // Update icon
-    if (!context->current_path.empty()) {
-        Fl_RGB_Image* icon = IconManager::Get().GetSpecificIcon(context->current_path);
-        if (!icon) {
-            // Fallback to generic directory icon
-            icon = IconManager::Get().GetIcon(context->current_path, true);
-        }
-        
-        if (icon != current_icon) {
-            current_icon = icon;
-            if (on_icon_changed) on_icon_changed(icon);
-        }
+    return context->hibernation_queued || !context->hibernation_file.empty();
+}
+
+void ExplorerTab::Refresh() {
+    TRACE_SPAN("ExplorerTab::Refresh", "ui");
+    // Everything, as if every kind of update had been posted
+    context->updates.Post(core::kUpdateAll);
+    Drain();
+}
+
+void ExplorerTab::ScheduleDrain() {
+    if (drain_scheduled) return;
+    double since = std::chrono::duration<double>(std::chrono::steady_clock::now() - last_drain).count();
+    if (since >= kFrameSeconds) {
+        Drain();
+        return;
+    }
+    // Drained less than a frame ago: whatever arrives until then rides along
+    drain_scheduled = true;
+    Fl::add_timeout(kFrameSeconds - since, DrainTimeout, this);
+}
+
+void ExplorerTab::DrainTimeout(void* data) {
+    ExplorerTab* tab = static_cast<ExplorerTab*>(data);
+    tab->drain_scheduled = false;
+    tab->Drain();
+}
+
+void ExplorerTab::Drain() {
+    TRACE_SPAN("ExplorerTab::Drain", "ui");
+    last_drain = std::chrono::steady_clock::now();
+    uint32_t flags = context->updates.Take();
+    if (!flags) return;
+
+    if (flags & core::kUpdateRows) file_table->SnapshotChanged();
+    if (flags & core::kUpdateLocation) UpdateIcon();
+    if (on_state_changed) on_state_changed(flags);
+}
+
+void ExplorerTab::UpdateIcon() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        path = context->current_path;
     }
+
+    // Only when the folder changed. The shell lookup can take a while on
+    // network paths, so it runs on the pool.
+    if (!path.empty() && path != icon_path) {
+        icon_path = path;
+        SetCurrentIcon(IconManager::Get().GetIcon(core::kIconFolder));
+        IconManager::Get().RequestSpecificIcon(path, false, this, [this, path](Fl_RGB_Image* icon) {
+            if (!icon) return;
+            if (path != icon_path) { // Navigated on meanwhile
+                delete icon;
+                return;
+            }
+            std::unique_ptr<Fl_RGB_Image> previous = std::move(specific_icon);
+            specific_icon.reset(icon);
+            SetCurrentIcon(icon);
+        });
+    }
+}
+
+void ExplorerTab::SetCurrentIcon(Fl_RGB_Image* icon) {
+    if (icon == current_icon) return;
+    current_icon = icon;
+    if (on_icon_changed) on_icon_changed(icon);
 }
 
 }
@@ -5,8 +5,11 @@
 #include <FL/Fl_RGB_Image.H>
 #include <memory>
 #include "../core/TabContext.h"
+#include "../core/Session.h"
 #include "FileTable.h"
 #include <functional>
+#include <chrono>
+#include <cstdint>
 
 namespace ui {
 
@@ -16,6 +19,23 @@ public:
     ~ExplorerTab();
 
     void Navigate(const char* path);
+    // Re-reads the current folder from disk, skipping the listing cache
+    void Reload();
+    // Reopens a tab from the last session (see core::Session): its sort and
+    // scroll position, then the folder, which paints from the saved listing
+    void Restore(const core::SessionTab& saved);
+    int TopRow() { return file_table->TopRow(); }
+
+    // A hidden tab can spill its listing to file to save memory (see
+    // ExplorerWindow::EnforceTabBudget) and reads it back when shown
+    void Hibernate(const std::string& file);
+    // Back to where it was scrolled, with the same rows selected
+    void Wake();
+    bool Hibernating();
+    size_t ListingBytes() { return context->Snapshot()->MemoryUsage(); }
+    // When the tab was last hidden; the longest hidden hibernate first
+    std::chrono::steady_clock::time_point hidden_at;
+    // Applies every pending kind of update now
     void Refresh();
     
     std::shared_ptr<core::TabContext> GetContext() { return context; }
@@ -24,8 +44,9 @@ public:
     std::function<void(ExplorerTab*)> on_close;
     
     // Callback for state changes (loading finished, etc.)
-    std::function<void()> on_state_changed;
-    void SetStateChangeCallback(std::function<void()> cb) { on_state_changed = cb; }
+    // (core::UpdateFlags that were drained)
+    std::function<void(uint32_t)> on_state_changed;
+    void SetStateChangeCallback(std::function<void(uint32_t)> cb) { on_state_changed = cb; }
 
     // Callback for icon changes
     std::function<void(Fl_RGB_Image*)> on_icon_changed;
@@ -40,6 +61,21 @@ private:
     FileTable* file_table;
     std::shared_ptr<core::TabContext> context;
     Fl_RGB_Image* current_icon = nullptr;
+    std::string icon_path; // Path current_icon was resolved for
+    // Shell icon for icon_path once it arrives; the generic folder shows until then
+    std::unique_ptr<Fl_RGB_Image> specific_icon;
+    FileTable::ViewState hibernated_view;
+    void SetCurrentIcon(Fl_RGB_Image* icon);
+    void UpdateIcon();
+
+    // Worker updates are drained at most once per display frame, so the UI
+    // thread's share of a large load stays flat however fast rows arrive
+    static constexpr double kFrameSeconds = 1.0 / 60;
+    void ScheduleDrain();
+    void Drain();
+    static void DrainTimeout(void* data);
+    bool drain_scheduled = false;
+    std::chrono::steady_clock::time_point last_drain;
 };
 
 }
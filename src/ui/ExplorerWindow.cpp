@@ -2,39 +2,28 @@
 #include "../core/AppState.h"
 #include "../core/FileSystem.h"
 #include "../core/Logger.h"
+#include "../core/Trace.h"
+#include "../core/Metrics.h"
+#include "../core/TaskScheduler.h"
+#include "../core/StartupProfiler.h"
+#include "../core/Session.h"
 #include "IconManager.h"
-#include <thread>
 #include <windows.h> // For CoInitialize
 #include <FL/fl_draw.H>
 #include <FL/x.H>
 #include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstdio>
 
 namespace ui {
 
-// Static callback for setting icon on main thread
-void SetIconCallback(void* data) {
-    auto* pair = static_cast<std::pair<ExplorerWindow*, Fl_RGB_Image*>*>(data);
-    if (pair->first) {
-        pair->first->SetAppIcon(pair->second);
-    }
-    delete pair;
-}
-
-// Static callback to start the thread after a delay
+// Static callback to queue the icon load after a delay
 void ScheduledIconLoad(void* data) {
     ExplorerWindow* win = static_cast<ExplorerWindow*>(data);
-    std::thread([win]() {
-        // Initialize COM for this thread
-        CoInitialize(NULL);
-        
-        Fl_RGB_Image* icon = IconManager::Get().GetSpecificIcon("C:\\Windows\\explorer.exe", true);
-        
-        CoUninitialize();
-
-        if (icon) {
-            Fl::awake(SetIconCallback, new std::pair<ExplorerWindow*, Fl_RGB_Image*>(win, icon));
-        }
-    }).detach();
+    IconManager::Get().RequestSpecificIcon("C:\\Windows\\explorer.exe", true, win, [win](Fl_RGB_Image* icon) {
+        if (icon) win->SetAppIcon(icon);
+    });
 }
 
 // Custom Button for Navigation to handle disabled state styling
@@ -64,11 +53,15 @@ public:
 
 ExplorerWindow::ExplorerWindow(int w, int h, const char* title, std::chrono::steady_clock::time_point start_time) 
     : Fl_Double_Window(w, h, title), start_time(start_time) {
+    using Startup = core::StartupProfiler;
+    Startup::Clock::time_point phase_start = Startup::Clock::now();
+
     // Remove OS border
     border(0);
     
     // Schedule icon loading to run after startup
     Fl::add_timeout(0.0, ScheduledIconLoad, this);
+    Fl::add_timeout(kMetricsDumpSeconds, MetricsDumpTimeout, this);
 
     // Try to load position, otherwise center
     if (!LoadWindowPos()) {
@@ -184,11 +177,14 @@ ExplorerWindow::ExplorerWindow(int w, int h, const char* title, std::chrono::ste
     int main_h = h - main_y - 25; // Minus status bar
     
     // Sidebar (Left)
+    Startup::Get().Record("window.chrome", phase_start, Startup::Clock::now());
+    phase_start = Startup::Clock::now();
     int sidebar_w = 200;
     sidebar = new Sidebar(0, main_y, sidebar_w, main_h);
     sidebar->SetNavigateCallback([this](const std::string& path) {
         this->Navigate(path.c_str());
     });
+    Startup::Get().Record("window.sidebar", phase_start, Startup::Clock::now());
 
     // Content Area (Right of Sidebar)
     int content_x = sidebar_w;
@@ -209,8 +205,10 @@ ExplorerWindow::ExplorerWindow(int w, int h, const char* title, std::chrono::ste
     
     core::g_main_window = this;
     
-    // Add initial tab
-    AddTab("C:/");
+    // Tabs from the last run, else the initial tab
+    phase_start = Startup::Clock::now();
+    if (!RestoreSession()) AddTab("C:/");
+    Startup::Get().Record("window.first_tab", phase_start, Startup::Clock::now());
     
     // Force layout update to match current window size (in case LoadWindowPos changed it)
     resize(x(), y(), this->w(), this->h());
@@ -218,10 +216,22 @@ ExplorerWindow::ExplorerWindow(int w, int h, const char* title, std::chrono::ste
 
 ExplorerWindow::~ExplorerWindow() {
     SaveWindowPos();
+    Fl::remove_timeout(MetricsTimeout, this);
+    Fl::remove_timeout(MetricsDumpTimeout, this);
+    IconManager::Get().CancelSpecificIcons(this);
     if (app_icon) delete app_icon;
 }
 
 int ExplorerWindow::handle(int event) {
+    if (event == FL_SHORTCUT && Fl::event_key() == FL_F + 12 && core::Tracer::Get().Enabled()) {
+        ExportTrace();
+        return 1;
+    }
+    if (event == FL_SHORTCUT && Fl::event_key() == FL_F + 11) {
+        ToggleMetrics();
+        return 1;
+    }
+
     // Prioritize resize cursor and hit testing
     if (event == FL_MOVE) {
         int dir = GetResizeDir(Fl::event_x(), Fl::event_y());
@@ -439,8 +449,8 @@ void ExplorerWindow::NavButtonCallback(Fl_Widget* w, void* data) {
             }
         }
     } else if (w == win->btn_refresh) {
-        // Use Navigate to reload safely
-        win->active_tab->Navigate(current_path.c_str());
+        // Explicit refresh bypasses the listing cache
+        win->active_tab->Reload();
     }
 }
 
@@ -452,37 +462,51 @@ void ExplorerWindow::SetAppIcon(Fl_RGB_Image* icon) {
 }
 
 void ExplorerWindow::AddTab(const char* path) {
+    ExplorerTab* tab = CreateTab(path);
+    // Initial navigation; the history starts empty
+    tab->Navigate(path);
+    SetActiveTab(tab);
+}
+
+ExplorerTab* ExplorerWindow::CreateTab(const char* label) {
     content_area->begin();
     ExplorerTab* tab = new ExplorerTab(content_area->x(), content_area->y(), content_area->w(), content_area->h());
     content_area->add(tab);
     content_area->end();
     
     // Hook up state change callback (for UI refresh and logging)
-    tab->SetStateChangeCallback([this, tab]() {
+    tab->SetStateChangeCallback([this, tab](uint32_t flags) {
         // Refresh UI if this is the active tab
         if (this->active_tab == tab) {
-            this->RefreshUI();
+            this->RefreshUI(flags);
         }
 
         // Check if loading finished (Startup Logging)
-        if (!startup_logged) {
-            auto context = tab->GetContext();
-            std::lock_guard<std::mutex> lock(context->mutex);
-            if (!context->is_loading) {
-                CheckStartupTime();
-            }
+        if (!startup_logged && (flags & core::kUpdateState) && !tab->GetContext()->is_loading) {
+            CheckStartupTime();
+        }
+
+        // A hidden tab finished loading and may have grown past the budget
+        if (this->active_tab != tab && (flags & core::kUpdateState)) {
+            EnforceTabBudget();
         }
         
         // Update tab title
-        auto context = tab->GetContext();
-        std::string label = context->current_path;
-        if (label.empty()) label = "New Tab";
-        else {
-            if (label.back() == '/' || label.back() == '\\') label.pop_back();
-            size_t pos = label.find_last_of("/\\");
-            if (pos != std::string::npos) label = label.substr(pos + 1);
+        if (flags & core::kUpdateLocation) {
+            auto context = tab->GetContext();
+            std::string label;
+            {
+                std::lock_guard<std::mutex> lock(context->mutex);
+                label = context->current_path;
+            }
+            if (label.empty()) label = "New Tab";
+            else {
+                if (label.back() == '/' || label.back() == '\\') label.pop_back();
+                size_t pos = label.find_last_of("/\\");
+                if (pos != std::string::npos) label = label.substr(pos + 1);
+            }
+            tab_bar->UpdateTabLabel(tab, label.c_str());
         }
-        tab_bar->UpdateTabLabel(tab, label.c_str());
     });
     
     // Set icon change callback
@@ -495,17 +519,59 @@ void ExplorerWindow::AddTab(const char* path) {
         this->Navigate(path.c_str());
     });
     
-    // Initial navigation
-    // Note: We don't push initial path to history usually, or we do?
-    // Let's say initial path is just current. History empty.
-    tab->Navigate(path);
-    
     // Add to TabBar
-    std::string label = "New Tab";
-    if (path) label = path;
-    tab_bar->AddTab(label.c_str(), tab);
-    
-    SetActiveTab(tab);
+    tab_bar->AddTab(label ? label : "New Tab", tab);
+    return tab;
+}
+
+bool ExplorerWindow::RestoreSession() {
+    core::Session session;
+    {
+        core::StartupProfiler::Phase phase("session.load");
+        if (!core::LoadSession(core::GetConfigDir() + "/session.bin", session)) return false;
+    }
+    LOG_INFO("Restoring " + std::to_string(session.tabs.size()) + " tabs from the last session");
+
+    // The active tab's listing is already decoded and paints in the first
+    // frame; hidden tabs decode and revalidate behind it on the pool
+    std::vector<ExplorerTab*> tabs;
+    for (size_t i = 0; i < session.tabs.size(); ++i) {
+        const core::SessionTab& saved = session.tabs[i];
+        ExplorerTab* tab = CreateTab(saved.path.c_str());
+        tab->GetContext()->is_active = (static_cast<int>(i) == session.active);
+        tab->Restore(saved);
+        tabs.push_back(tab);
+    }
+    SetActiveTab(tabs[session.active]);
+    return true;
+}
+
+void ExplorerWindow::SaveSession() {
+    core::Session session;
+    for (int i = 0; i < content_area->children(); ++i) {
+        ExplorerTab* tab = static_cast<ExplorerTab*>(content_area->child(i));
+        auto context = tab->GetContext();
+        core::SessionTab saved;
+        {
+            std::lock_guard<std::mutex> lock(context->mutex);
+            saved.path = context->current_path;
+            saved.sort = context->sort;
+        }
+        if (saved.path.empty()) continue;
+        saved.top_row = tab->TopRow();
+        // Only a finished listing; a partial one would restore as complete,
+        // and hibernated tabs keep just their place
+        auto snapshot = context->Snapshot();
+        if (!context->is_loading && snapshot->Single()) {
+            saved.listing = snapshot->parts[0];
+            if (snapshot->spec == saved.sort) saved.order = snapshot->order;
+        }
+        if (tab == active_tab) session.active = static_cast<int>(session.tabs.size());
+        session.tabs.push_back(std::move(saved));
+    }
+    if (!core::SaveSession(core::GetConfigDir() + "/session.bin", session)) {
+        LOG_WARN("Could not save the session");
+    }
 }
 
 void ExplorerWindow::CloseTab(ExplorerTab* tab) {
@@ -532,6 +598,7 @@ void ExplorerWindow::CloseTab(ExplorerTab* tab) {
 }
 
 void ExplorerWindow::SetActiveTab(ExplorerTab* tab) {
+    if (active_tab && active_tab != tab) active_tab->hidden_at = std::chrono::steady_clock::now();
     active_tab = tab;
     
     // Show only active tab
@@ -539,22 +606,66 @@ void ExplorerWindow::SetActiveTab(ExplorerTab* tab) {
         Fl_Widget* child = content_area->child(i);
         if (child == tab) child->show();
         else child->hide();
+        // Loads for hidden tabs yield to the visible one
+        ((ExplorerTab*)child)->GetContext()->is_active = (child == tab);
     }
+    // After is_active is set, so a hibernation still queued gives up
+    tab->Wake();
+    EnforceTabBudget();
     
     tab_bar->SelectTab(tab);
     RefreshUI();
     content_area->redraw();
 }
 
-void ExplorerWindow::RefreshUI() {
+void ExplorerWindow::EnforceTabBudget() {
+    std::vector<ExplorerTab*> hidden;
+    for (int i = 0; i < content_area->children(); i++) {
+        ExplorerTab* tab = (ExplorerTab*)content_area->child(i);
+        if (tab != active_tab && !tab->Hibernating()) hidden.push_back(tab);
+    }
+    // Most recently hidden first; whatever does not fit after them sleeps
+    std::sort(hidden.begin(), hidden.end(), [](ExplorerTab* a, ExplorerTab* b) {
+        return a->hidden_at > b->hidden_at;
+    });
+    size_t kept = 0;
+    for (ExplorerTab* tab : hidden) {
+        size_t bytes = tab->ListingBytes();
+        if (kept + bytes <= kHiddenTabBudget) {
+            kept += bytes;
+            continue;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(HibernationDir(), ec);
+        tab->Hibernate(HibernationDir() + "/tab" + std::to_string(next_hibernation_id++) + ".bin");
+    }
+}
+
+void ExplorerWindow::RemoveHibernatedListings() {
+    // Hibernated listings only live for the run; other instances keep theirs
+    std::error_code ec;
+    std::filesystem::remove_all(HibernationDir(), ec);
+}
+
+// One folder per process: another instance numbers its spills from zero too
+std::string ExplorerWindow::HibernationDir() {
+    return core::GetConfigDir() + "/hibernated/" + std::to_string(GetCurrentProcessId());
+}
+
+void ExplorerWindow::RefreshUI(uint32_t flags) {
     if (!active_tab) return;
     
     auto context = active_tab->GetContext();
     std::lock_guard<std::mutex> lock(context->mutex);
     
-    // Update Status
-    status_bar->label(context->status_text.c_str());
-    status_bar->redraw();
+    // Update Status. Copied: workers rewrite status_text once we unlock.
+    if ((flags & core::kUpdateStatus) && !metrics_mode) {
+        status_bar->copy_label(context->status_text.c_str());
+        status_bar->redraw();
+    }
+    
+    // Rows and status alone leave the chrome as it is
+    if (!(flags & (core::kUpdateLocation | core::kUpdateState))) return;
     
     // Update Address Bar
     if (address_bar) address_bar->value(context->current_path.c_str());
@@ -640,10 +751,77 @@ void ExplorerWindow::CheckStartupTime() {
     if (startup_logged) return;
     
     auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count();
-    
-    core::Log("Total startup load time: " + std::to_string(duration) + " ms");
+    // The full report is logged once the listing is painted
+    core::StartupProfiler::Get().Mark("first_listing_loaded");
     startup_logged = true;
+
+    // The whole startup as one span, from main's first line
+    core::Tracer& tracer = core::Tracer::Get();
+    if (tracer.Enabled()) {
+        int64_t end = tracer.Now();
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time).count();
+        tracer.Record("Startup", "app", std::max<int64_t>(0, end - elapsed), end);
+    }
+}
+
+void ExplorerWindow::ToggleMetrics() {
+    metrics_mode = !metrics_mode;
+    if (metrics_mode) {
+        shown_entries = core::Metrics::Get().GetCounter("load.entries").Value();
+        shown_at = std::chrono::steady_clock::now();
+        ShowMetrics();
+        Fl::add_timeout(0.5, MetricsTimeout, this);
+    } else {
+        Fl::remove_timeout(MetricsTimeout, this);
+        RefreshUI(core::kUpdateStatus);
+    }
+}
+
+void ExplorerWindow::MetricsTimeout(void* data) {
+    ExplorerWindow* window = static_cast<ExplorerWindow*>(data);
+    window->ShowMetrics();
+    Fl::repeat_timeout(0.5, MetricsTimeout, data);
+}
+
+void ExplorerWindow::ShowMetrics() {
+    core::Metrics& metrics = core::Metrics::Get();
+    auto now = std::chrono::steady_clock::now();
+    uint64_t entries = metrics.GetCounter("load.entries").Value();
+    double seconds = std::chrono::duration<double>(now - shown_at).count();
+    double rate = seconds > 0 ? (entries - shown_entries) / seconds : 0;
+    shown_entries = entries;
+    shown_at = now;
+
+    uint64_t hits = metrics.GetCounter("icons.table_hits").Value();
+    uint64_t lookups = hits + metrics.GetCounter("icons.disk_hits").Value() +
+        metrics.GetCounter("icons.shell_requests").Value();
+    uint64_t loads = metrics.GetCounter("load.count").Value();
+    uint64_t awakes = metrics.GetCounter("ui.awakes").Value();
+    core::Histogram& frame = metrics.GetHistogram("ui.frame");
+
+    char text[256];
+    std::snprintf(text, sizeof(text),
+                  "%.0f entries/s | icon hits %.1f%% | frame p50 %.2f ms p99 %.2f ms | %.1f awakes/load | %lld loading",
+                  rate, lookups ? 100.0 * hits / lookups : 0.0, frame.Percentile(0.5) / 1e6,
+                  frame.Percentile(0.99) / 1e6, loads ? static_cast<double>(awakes) / loads : 0.0,
+                  static_cast<long long>(metrics.GetGauge("load.in_flight").Value()));
+    status_bar->copy_label(text);
+    status_bar->redraw();
+}
+
+void ExplorerWindow::MetricsDumpTimeout(void* data) {
+    std::string path = core::GetConfigDir() + "/metrics.txt";
+    core::TaskScheduler::Get().Submit(core::TaskPriority::Indexing, [path]() {
+        core::Metrics::Get().DumpTo(path);
+    });
+    Fl::repeat_timeout(kMetricsDumpSeconds, MetricsDumpTimeout, data);
+}
+
+void ExplorerWindow::ExportTrace() {
+    std::string path = core::GetConfigDir() + "/trace.json";
+    bool ok = core::Tracer::Get().ExportChromeJson(path);
+    status_bar->copy_label(((ok ? "Trace written to " : "Could not write ") + path).c_str());
+    LOG_INFO((ok ? "Trace written to " : "Could not write trace to ") + path);
 }
 
 void ExplorerWindow::resize(int x, int y, int w, int h) {
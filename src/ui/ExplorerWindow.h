@@ -10,6 +10,7 @@
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <string>
 
 namespace ui {
 
@@ -18,12 +19,19 @@ public:
     ExplorerWindow(int w, int h, const char* title, std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now());
     ~ExplorerWindow();
     
-    void RefreshUI(); // Updates status from active tab
+    void RefreshUI(uint32_t flags = core::kUpdateAll); // Updates status from active tab
     void SetAddress(const char* path); // Updates global address bar
     void UpdateStatus();
     void SetAppIcon(Fl_RGB_Image* icon);
     void Navigate(const char* path);
     void AddTab(const char* path);
+    // Tabs from the last run (core::Session); false if there were none
+    bool RestoreSession();
+    // Called by main after the event loop, while the logger still runs
+    void SaveSession();
+    // This run's hibernated listings; call once the pool has stopped, so no
+    // spill is still being written
+    void RemoveHibernatedListings();
     void CloseTab(ExplorerTab* tab);
     void SetActiveTab(ExplorerTab* tab);
     
@@ -57,6 +65,16 @@ private:
     Fl_RGB_Image* app_icon = nullptr;
     
     ExplorerTab* active_tab = nullptr;
+    // A wired up tab in the tab bar, not yet navigated or shown
+    ExplorerTab* CreateTab(const char* label);
+
+    // Hidden tabs keep at most this much listing memory; past it the longest
+    // hidden are hibernated (see ExplorerTab::Hibernate). ListingCache has
+    // its own budget for the listings it shares.
+    static const size_t kHiddenTabBudget = 256 * 1024 * 1024;
+    void EnforceTabBudget();
+    std::string HibernationDir();
+    uint64_t next_hibernation_id = 0;
     
     static void NewTabCallback(Fl_Widget* w, void*);
     static void WindowControlCallback(Fl_Widget* w, void* data);
@@ -92,6 +110,19 @@ private:
     std::chrono::steady_clock::time_point start_time;
     bool startup_logged = false;
     void CheckStartupTime();
+    // F12 while tracing: writes the spans so far next to the config
+    void ExportTrace();
+
+    // F11 switches the status bar to live metrics (see core::Metrics)
+    bool metrics_mode = false;
+    uint64_t shown_entries = 0;
+    std::chrono::steady_clock::time_point shown_at;
+    void ToggleMetrics();
+    void ShowMetrics();
+    static void MetricsTimeout(void* data);
+    // Written on the pool every kMetricsDumpSeconds and at exit
+    static const int kMetricsDumpSeconds = 60;
+    static void MetricsDumpTimeout(void* data);
 };
 
 }
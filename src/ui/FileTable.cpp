@@ -1,6 +1,10 @@
 #include "FileTable.h"
 #include "../core/AppState.h"
 #include "../core/FileSystem.h"
+#include "../core/ListingSort.h"
+#include "../core/Trace.h"
+#include "../core/Metrics.h"
+#include "../core/StartupProfiler.h"
 #include "IconManager.h"
 #include <FL/fl_draw.H>
 #include <FL/Fl.H>
@@ -9,13 +13,15 @@
 #include <FL/Fl_Menu_Item.H>
 #include <FL/fl_ask.H>
 #include "../core/QuickAccess.h"
+#include <cstdio>
+#include <cctype>
 
 namespace ui {
 
 FileTable::FileTable(int x, int y, int w, int h, const char* l, std::shared_ptr<core::TabContext> context) 
     : Fl_Table_Row(x, y, w, h, l), tab_context(context) {
     rows(0);
-    cols(3); // Name, Size, Type
+    cols(4); // Name, Size, Type, Date modified
     
     col_header(1);
     col_resize(1);
@@ -23,6 +29,7 @@ FileTable::FileTable(int x, int y, int w, int h, const char* l, std::shared_ptr<
     col_width(0, 400); // Name
     col_width(1, 100); // Size
     col_width(2, 80);  // Type (Dir/File)
+    col_width(3, 130); // Date modified
     
     // Scrollbar styling
     // Fl_Table exposes vscrollbar and hscrollbar as public pointers
@@ -42,6 +49,77 @@ FileTable::FileTable(int x, int y, int w, int h, const char* l, std::shared_ptr<
     }
 
     end();
+
+    // Rows drawn with a placeholder get the real icon once it lands
+    icons_listener = IconManager::Get().AddIconsLoadedListener([this]() {
+        if (!waiting_for_icons) return;
+        waiting_for_icons = false;
+        int r1, r2, c1, c2;
+        visible_cells(r1, r2, c1, c2);
+        if (c1 == 0 && r1 <= r2) redraw_range(r1, r2, 0, 0);
+    });
+}
+
+FileTable::~FileTable() {
+    IconManager::Get().RemoveIconsLoadedListener(icons_listener);
+}
+
+void FileTable::SnapshotChanged() {
+    // The next draw takes the new snapshot; a hidden table would otherwise
+    // keep the old listing alive
+    frame.reset();
+    auto snapshot = tab_context->Snapshot();
+    // Same version means streamed rows were appended and shown rows stand;
+    // rows() repaints by itself when the new ones land inside the viewport
+    bool appended = snapshot->version == shown_version;
+    shown_version = snapshot->version;
+    int count = (int)snapshot->size();
+    if (count != rows()) rows(count);
+    if (view_pending && count > pending_view.top_row) ApplyView();
+    if (!appended) redraw();
+}
+
+FileTable::ViewState FileTable::SaveView() {
+    ViewState view;
+    view.top_row = top_row();
+    for (int r = 0; r < rows(); ++r) {
+        if (row_selected(r)) view.selected.push_back(r);
+    }
+    return view;
+}
+
+void FileTable::RestoreView(ViewState view) {
+    pending_view = std::move(view);
+    view_pending = true;
+    if (rows() > pending_view.top_row) ApplyView();
+}
+
+void FileTable::ApplyView() {
+    view_pending = false;
+    top_row(pending_view.top_row);
+    for (int r : pending_view.selected) {
+        if (r < rows()) select_row(r, 1);
+    }
+    pending_view = ViewState();
+}
+
+void FileTable::draw() {
+    TRACE_SPAN("FileTable::draw", "ui");
+    static core::Histogram& frame_time = core::Metrics::Get().GetHistogram("ui.frame");
+    core::ScopedTimer timer(frame_time);
+    // One snapshot for the whole frame: every cell sees the same listing,
+    // and a worker publishing a new one never blocks drawing
+    frame = tab_context->Snapshot();
+    Fl_Table_Row::draw();
+
+    // The first frame showing a listing ends startup: a finished one, or
+    // rows from the cache or a restored session
+    static bool startup_done = false;
+    if (!startup_done && (!tab_context->is_loading || !frame->empty())) {
+        startup_done = true;
+        core::StartupProfiler::Get().Mark("first_paint");
+        core::StartupProfiler::Get().Finish();
+    }
 }
 
 void FileTable::draw_cell(TableContext context, int R, int C, int X, int Y, int W, int H) {
@@ -63,6 +141,12 @@ void FileTable::draw_cell(TableContext context, int R, int C, int X, int Y, int
         case 0: fl_draw("Name", X + 10, Y, W - 10, H, FL_ALIGN_LEFT); break;
         case 1: fl_draw("Size", X + 10, Y, W - 10, H, FL_ALIGN_LEFT); break;
         case 2: fl_draw("Type", X + 10, Y, W - 10, H, FL_ALIGN_LEFT); break;
+        case 3: fl_draw("Date modified", X + 10, Y, W - 10, H, FL_ALIGN_LEFT); break;
+        }
+        // Sort indicator
+        if (C == (int)sort_spec.column) {
+            fl_color(fl_rgb_color(160, 160, 160));
+            fl_draw(sort_spec.ascending ? "▲" : "▼", X, Y, W - 8, H, FL_ALIGN_RIGHT);
         }
         fl_pop_clip();
         return;
@@ -78,46 +162,50 @@ void FileTable::draw_cell(TableContext context, int R, int C, int X, int Y, int
         }
         fl_rectf(X, Y, W, H);
 
-        // Data
-        {
-            std::lock_guard<std::mutex> lock(tab_context->mutex);
+        // Data (from this frame's snapshot, no locking)
+        if (frame && R < (int)frame->size()) {
+            size_t i;
+            const core::Listing& files = frame->Row(R, i);
+            bool is_dir = files.IsDir(i);
             
-            if (R < tab_context->files.size()) {
-                const auto& entry = tab_context->files[R];
-                
-                // Icon
-                int text_x = X + 5;
-                
-                if (C == 0) {
-                    Fl_RGB_Image* icon = IconManager::Get().GetIcon(entry.path, entry.is_dir);
-                    if (icon) {
-                        // Center icon vertically
-                        int icon_y = Y + (H - 16) / 2;
-                        icon->draw(X + 2, icon_y);
-                        text_x += 20; // Space for icon
+            // Icon
+            int text_x = X + 5;
+            
+            if (C == 0) {
+                // Icon type was resolved when the entry was loaded
+                Fl_RGB_Image* icon = IconManager::Get().GetIcon(files.Icon(i));
+                if (IconManager::Get().IsPlaceholder(icon)) waiting_for_icons = true;
+                if (icon) {
+                    // Center icon vertically
+                    int icon_y = Y + (H - 16) / 2;
+                    icon->draw(X + 2, icon_y);
+                    text_x += 20; // Space for icon
+                } else {
+                    // Fallback
+                    if (is_dir) {
+                        fl_color(FL_YELLOW);
+                        fl_rectf(X + 2, Y + 2, 10, H - 4);
                     } else {
-                        // Fallback
-                        if (entry.is_dir) {
-                            fl_color(FL_YELLOW);
-                            fl_rectf(X + 2, Y + 2, 10, H - 4);
-                        } else {
-                            fl_color(FL_BLUE);
-                            fl_rectf(X + 4, Y + 4, 6, H - 8);
-                        }
-                        text_x += 15;
+                        fl_color(FL_BLUE);
+                        fl_rectf(X + 4, Y + 4, 6, H - 8);
                     }
-                    
-                    fl_color(FL_WHITE);
-                    fl_draw(entry.name.c_str(), text_x, Y, W - (text_x - X), H, FL_ALIGN_LEFT);
-                }
-                else if (C == 1) {
-                    fl_color(fl_rgb_color(200, 200, 200)); // Light gray text for size
-                    fl_draw(entry.size_str.c_str(), X + 10, Y, W - 10, H, FL_ALIGN_LEFT);
-                }
-                else if (C == 2) {
-                    fl_color(fl_rgb_color(200, 200, 200)); // Light gray text for type
-                    fl_draw(entry.is_dir ? "File folder" : "File", X + 10, Y, W - 10, H, FL_ALIGN_LEFT);
+                    text_x += 15;
                 }
+                
+                fl_color(FL_WHITE);
+                fl_draw(files.NameCStr(i), text_x, Y, W - (text_x - X), H, FL_ALIGN_LEFT);
+            }
+            else if (C == 1) {
+                fl_color(fl_rgb_color(200, 200, 200)); // Light gray text for size
+                fl_draw(GetRowText(files, R, i).size, X + 10, Y, W - 10, H, FL_ALIGN_LEFT);
+            }
+            else if (C == 2) {
+                fl_color(fl_rgb_color(200, 200, 200)); // Light gray text for type
+                fl_draw(GetRowText(files, R, i).type, X + 10, Y, W - 10, H, FL_ALIGN_LEFT);
+            }
+            else if (C == 3) {
+                fl_color(fl_rgb_color(200, 200, 200)); // Light gray text for date
+                fl_draw(GetRowText(files, R, i).date, X + 10, Y, W - 10, H, FL_ALIGN_LEFT);
             }
         }
         
@@ -135,6 +223,39 @@ void FileTable::draw_cell(TableContext context, int R, int C, int X, int Y, int
     }
 }
 
+// Keyed by the snapshot version of the frame being drawn
+const FileTable::RowText& FileTable::GetRowText(const core::Listing& files, int R, size_t i) {
+    if (row_cache_version != frame->version) {
+        for (auto& slot : row_cache) slot.row = -1;
+        row_cache_version = frame->version;
+    }
+
+    RowText& slot = row_cache[R % kRowCacheSize];
+    if (slot.row != R) {
+        if (files.IsDir(i)) {
+            std::snprintf(slot.size, sizeof(slot.size), "<DIR>");
+            std::snprintf(slot.type, sizeof(slot.type), "File folder");
+        } else {
+            if (files.SizeKnown(i)) {
+                core::FormatSize(files.Size(i), slot.size, sizeof(slot.size));
+            } else {
+                std::snprintf(slot.size, sizeof(slot.size), "Unknown");
+            }
+            // "TXT File", like Explorer; plain "File" without an extension
+            std::string_view ext = core::FileExtension(files.Name(i));
+            size_t n = 0;
+            for (char c : ext) {
+                if (n + 6 >= sizeof(slot.type)) break;
+                slot.type[n++] = (char)std::toupper((unsigned char)c);
+            }
+            std::snprintf(slot.type + n, sizeof(slot.type) - n, n ? " File" : "File");
+        }
+        core::FormatTime(files.MTime(i), slot.date, sizeof(slot.date));
+        slot.row = R;
+    }
+    return slot;
+}
+
 #include <windows.h>
 #include <shellapi.h>
 
@@ -169,6 +290,16 @@ int FileTable::handle(int event) {
         }
     }
 
+    // Header click sorts by that column (but not when grabbing a column edge)
+    if (event == FL_PUSH && Fl::event_button() == FL_LEFT_MOUSE) {
+        int R, C;
+        ResizeFlag resize_flag;
+        if (cursor2rowcol(R, C, resize_flag) == CONTEXT_COL_HEADER && resize_flag == RESIZE_NONE) {
+            SortByColumn(C);
+            return 1;
+        }
+    }
+
     // Right click handling
     if (event == FL_RELEASE && Fl::event_button() == FL_RIGHT_MOUSE) {
         // ... (existing right click logic)
@@ -224,14 +355,14 @@ int FileTable::handle(int event) {
         
         int r = callback_row();
         if (r >= 0) {
-             std::string path;
+            std::string path;
             bool is_dir = false;
-            {
-                std::lock_guard<std::mutex> lock(tab_context->mutex);
-                if (r < tab_context->files.size()) {
-                    path = tab_context->files[r].path;
-                    is_dir = tab_context->files[r].is_dir;
-                }
+            auto snapshot = tab_context->Snapshot();
+            if (r < (int)snapshot->size()) {
+                size_t i;
+                const core::Listing& files = snapshot->Row(r, i);
+                path = files.Path(i);
+                is_dir = files.IsDir(i);
             }
             
             if (!path.empty()) {
@@ -248,12 +379,12 @@ int FileTable::handle(int event) {
         if (r >= 0) {
             std::string path;
             bool is_dir = false;
-            {
-                std::lock_guard<std::mutex> lock(tab_context->mutex);
-                if (r < tab_context->files.size()) {
-                    path = tab_context->files[r].path;
-                    is_dir = tab_context->files[r].is_dir;
-                }
+            auto snapshot = tab_context->Snapshot();
+            if (r < (int)snapshot->size()) {
+                size_t i;
+                const core::Listing& files = snapshot->Row(r, i);
+                path = files.Path(i);
+                is_dir = files.IsDir(i);
             }
             
             if (!path.empty()) {
@@ -271,6 +402,19 @@ int FileTable::handle(int event) {
     return Fl_Table_Row::handle(event);
 }
 
+void FileTable::SortByColumn(int C) {
+    core::SortSpec spec = sort_spec;
+    if ((int)spec.column == C) {
+        spec.ascending = !spec.ascending;
+    } else {
+        spec.column = static_cast<core::SortColumn>(C);
+        spec.ascending = true;
+    }
+    sort_spec = spec;
+    core::ResortListing(tab_context, spec);
+    redraw(); // Header arrow now, rows again when the new order lands
+}
+
 void FileTable::ShowContextMenu(const std::string& path, bool is_dir) {
     bool is_pinned = false;
     if (is_dir) {
@@ -3,23 +3,68 @@
 #include <memory>
 #include "../core/TabContext.h"
 #include <string>
+#include <vector>
 
 namespace ui {
 
 class FileTable : public Fl_Table_Row {
 public:
     FileTable(int x, int y, int w, int h, const char* l, std::shared_ptr<core::TabContext> context);
+    ~FileTable();
     
     int handle(int event) override;
+    // A new snapshot was published: updates the row count and repaints
+    // only if rows already shown changed
+    void SnapshotChanged();
+
+    // Where the table was scrolled and which rows were selected, for a
+    // listing that goes away and comes back (restored or hibernated tabs)
+    struct ViewState {
+        int top_row = 0;
+        std::vector<int> selected;
+    };
+    ViewState SaveView();
+    // Applied once the listing has rows down to top_row
+    void RestoreView(ViewState view);
+    int TopRow() { return top_row(); }
+    // Header arrow for a sort the tab already uses (restored tabs)
+    void ShowSort(core::SortSpec spec) { sort_spec = spec; }
 
 private:
+    void draw() override;
     void draw_cell(TableContext context, int R, int C, int X, int Y, int W, int H) override;
     
     void ShowContextMenu(const std::string& path, bool is_dir);
     void CopyPathToClipboard(const std::string& path);
     void ShowProperties(const std::string& path);
 
+    // Formatted size/date text for recently drawn rows. Direct-mapped by row,
+    // so formatting cost follows the viewport rather than the directory.
+    struct RowText {
+        int row = -1;
+        char size[24];
+        char type[24];
+        char date[24];
+    };
+    static const int kRowCacheSize = 256;
+    RowText row_cache[kRowCacheSize];
+    uint64_t row_cache_version = UINT64_MAX;
+    const RowText& GetRowText(const core::Listing& files, int R, size_t i);
+
+    void SortByColumn(int C);
+    core::SortSpec sort_spec; // UI copy of tab_context->sort for the header
+
     std::shared_ptr<core::TabContext> tab_context;
+    // Listing state for the frame being drawn, taken once in draw()
+    std::shared_ptr<const core::ListingSnapshot> frame;
+    uint64_t shown_version = 0; // Snapshot version rows() was last set for
+    ViewState pending_view;     // See RestoreView
+    bool view_pending = false;
+    void ApplyView();
+
+    // Set when a cell drew a placeholder icon; see IconManager listeners
+    bool waiting_for_icons = false;
+    int icons_listener = 0;
     
 public:
     std::function<void(const std::string&)> on_navigate;
@@ -1,166 +1,298 @@
 #include "IconManager.h"
-#include <windows.h>
-#include <shellapi.h>
-#include <vector>
-#include <algorithm>
-
-// Ensure NOMINMAX is defined if not already (usually in CMake, but good safety)
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
+#include "../core/IconService.h"
+#include "../core/IconDiskCache.h"
+#include "../core/Metrics.h"
+#include <FL/Fl.H>
+#include <memory>
+#include <cstring>
 
 namespace ui {
 
+namespace {
+
+// Blocking lookups share one provider; the async path goes through IconService
+core::IconProvider& SyncProvider() {
+    static std::unique_ptr<core::IconProvider> provider = core::CreateIconProvider();
+    return *provider;
+}
+
+}
+
+Fl_RGB_Image* ToFlImage(core::IconBitmap&& bitmap) {
+    if (bitmap.width <= 0 || bitmap.height <= 0 || !bitmap.rgba) return nullptr;
+    // Depth 4 for RGBA. The image adopts the new[] buffer and frees it itself.
+    Fl_RGB_Image* img = new Fl_RGB_Image(bitmap.rgba.release(), bitmap.width, bitmap.height, 4);
+    img->alloc_array = 1;
+    return img;
+}
+
+Fl_RGB_Image* ToFlImage(const core::IconBitmap& bitmap) {
+    if (bitmap.width <= 0 || bitmap.height <= 0 || !bitmap.rgba) return nullptr;
+    core::IconBitmap copy;
+    copy.Allocate(bitmap.width, bitmap.height);
+    std::memcpy(copy.rgba.get(), bitmap.rgba.get(), bitmap.ByteSize());
+    return ToFlImage(std::move(copy));
+}
+
 IconManager& IconManager::Get() {
     static IconManager instance;
     return instance;
 }
 
+IconManager::Chunk::Chunk() {
+    for (size_t i = 0; i < kChunkSize; ++i) {
+        images[i].store(nullptr, std::memory_order_relaxed);
+        failed[i].store(false, std::memory_order_relaxed);
+        requested[i].store(false, std::memory_order_relaxed);
+    }
+}
+
+IconManager::IconManager() {
+    for (auto& chunk : chunks_) chunk.store(nullptr, std::memory_order_relaxed);
+
+    core::IconBitmap bitmap;
+    core::DrawPlaceholderIcon(true, core::IconSize(false), bitmap);
+    folder_placeholder = ToFlImage(std::move(bitmap));
+    core::DrawPlaceholderIcon(false, core::IconSize(false), bitmap);
+    file_placeholder = ToFlImage(std::move(bitmap));
+
+    core::IconService::Get().SetReadyCallback([this]() { ScheduleDrain(); });
+    // Requests parked until the disk cache was mapped are resolved by the drain
+    core::IconDiskCache::Get().SetReadyCallback([this]() { ScheduleDrain(); });
+}
+
 IconManager::~IconManager() {
-    for (auto& pair : icon_cache_) {
-        delete pair.second;
+    core::IconService::Get().SetReadyCallback(nullptr);
+    core::IconDiskCache::Get().SetReadyCallback(nullptr);
+    for (auto& slot : chunks_) {
+        Chunk* chunk = slot.load();
+        if (!chunk) continue;
+        for (auto& image : chunk->images) delete image.load();
+        delete chunk;
     }
+    delete folder_placeholder;
+    delete file_placeholder;
 }
 
-Fl_RGB_Image* IconManager::GetIcon(const std::string& path, bool is_dir) {
-    std::string key;
-    if (is_dir) {
-        key = "DIR";
-    } else {
-        size_t dot_pos = path.find_last_of('.');
-        if (dot_pos != std::string::npos) {
-            key = path.substr(dot_pos);
-            // Normalize extension to lower case
-            std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-        } else {
-            key = "NONE";
-        }
+IconManager::Chunk* IconManager::GetChunk(core::IconId id) {
+    std::atomic<Chunk*>& slot = chunks_[id / kChunkSize];
+    Chunk* chunk = slot.load(std::memory_order_acquire);
+    if (chunk) return chunk;
+
+    // First icon in this range; whoever loses the race frees its copy
+    Chunk* fresh = new Chunk();
+    if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) return fresh;
+    delete fresh;
+    return chunk;
+}
+
+Fl_RGB_Image* IconManager::Install(core::IconId id, Fl_RGB_Image* img) {
+    Chunk* chunk = GetChunk(id);
+    size_t i = id % kChunkSize;
+    if (!img) {
+        chunk->failed[i].store(true, std::memory_order_relaxed);
+        return chunk->images[i].load(std::memory_order_acquire);
     }
+    Fl_RGB_Image* expected = nullptr;
+    if (!chunk->images[i].compare_exchange_strong(expected, img, std::memory_order_acq_rel)) {
+        delete img;
+        img = expected;
+    }
+    return img;
+}
 
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    if (icon_cache_.find(key) != icon_cache_.end()) {
-        return icon_cache_[key];
+void IconManager::LoadType(core::IconId id) {
+    static core::Counter& disk_hits = core::Metrics::Get().GetCounter("icons.disk_hits");
+    static core::Counter& shell_requests = core::Metrics::Get().GetCounter("icons.shell_requests");
+    // Warm start: icons from the last run are a copy out of a mapped file
+    core::IconBitmap bitmap;
+    bool stale = false;
+    if (core::IconDiskCache::Get().Lookup(core::IconDiskCache::TypeKey(id), false, bitmap, &stale)) {
+        disk_hits.Add();
+        // Drawn as is; the drain stores the shell's answer for next time
+        if (stale) core::IconService::Get().RequestType(id, false, core::TaskPriority::Indexing);
+        Install(id, ToFlImage(std::move(bitmap)));
+        return;
     }
+    shell_requests.Add();
+    core::IconService::Get().RequestType(id, false);
+}
 
-    // Default to small icons for GetIcon
-    Fl_RGB_Image* img = LoadIconFromSystem(path, is_dir, false, false);
+Fl_RGB_Image* IconManager::GetIcon(core::IconId id) {
+    static core::Counter& table_hits = core::Metrics::Get().GetCounter("icons.table_hits");
+    Chunk* chunk = GetChunk(id);
+    size_t i = id % kChunkSize;
+    Fl_RGB_Image* img = chunk->images[i].load(std::memory_order_acquire);
     if (img) {
-        icon_cache_[key] = img;
+        table_hits.Add();
+        return img;
     }
-    return img;
+
+    Fl_RGB_Image* placeholder = id == core::kIconFolder ? folder_placeholder : file_placeholder;
+    if (chunk->failed[i].load(std::memory_order_relaxed)) {
+        // Types the shell has no icon for fall back to the generic file icon
+        if (id == core::kIconFolder || id == core::kIconGenericFile) return placeholder;
+        return GetIcon(core::kIconGenericFile);
+    }
+    if (!chunk->requested[i].exchange(true, std::memory_order_relaxed)) {
+        core::IconDiskCache& disk = core::IconDiskCache::Get();
+        if (!disk.Ready()) {
+            // The pool is still mapping last run's icons, which likely have
+            // this one; asking the shell now would extract it for nothing
+            disk.Open();
+            awaiting_disk.push_back(id);
+            return placeholder;
+        }
+        LoadType(id);
+        img = chunk->images[i].load(std::memory_order_acquire);
+        if (img) return img;
+    }
+    return placeholder;
+}
+
+bool IconManager::IsPlaceholder(const Fl_RGB_Image* img) const {
+    return img == folder_placeholder || img == file_placeholder;
+}
+
+Fl_RGB_Image* IconManager::GetIcon(const std::string& path, bool is_dir) {
+    core::IconId id = core::InternIconType(path, is_dir);
+    Chunk* chunk = GetChunk(id);
+    size_t i = id % kChunkSize;
+    Fl_RGB_Image* img = chunk->images[i].load(std::memory_order_acquire);
+    if (img || chunk->failed[i].load(std::memory_order_relaxed)) return img;
+
+    // Blocking anyway, so map the disk cache here rather than miss it
+    core::IconDiskCache::Get().Load();
+    core::IconBitmap bitmap;
+    std::string key = core::IconDiskCache::TypeKey(id);
+    if (core::IconDiskCache::Get().Lookup(key, false, bitmap)) return Install(id, ToFlImage(std::move(bitmap)));
+    bool ok = SyncProvider().LoadTypeIcon(id, false, bitmap);
+    if (ok) core::IconDiskCache::Get().Store(key, false, bitmap);
+    return Install(id, ok ? ToFlImage(std::move(bitmap)) : nullptr);
 }
 
 Fl_RGB_Image* IconManager::GetSpecificIcon(const std::string& path, bool large) {
-    return LoadIconFromSystem(path, false, true, large);
-}
-
-// Helper to convert HICON to Fl_RGB_Image
-Fl_RGB_Image* HIconToFlImage(HICON hIcon) {
-    if (!hIcon) return nullptr;
-
-    ICONINFO iconInfo;
-    GetIconInfo(hIcon, &iconInfo);
-    
-    // Get dimensions
-    BITMAP bmp;
-    GetObject(iconInfo.hbmColor, sizeof(BITMAP), &bmp);
-    int width = bmp.bmWidth;
-    int height = bmp.bmHeight; // Could be negative if top-down? No, GetObject returns abs usually for BITMAP struct?
-    // Actually BITMAP struct has bmHeight > 0.
-    
-    HDC hDC = GetDC(NULL);
-    HDC hMemDC = CreateCompatibleDC(hDC);
-    
-    BITMAPINFO bmi;
-    memset(&bmi, 0, sizeof(bmi));
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = width;
-    bmi.bmiHeader.biHeight = -height; // Top-down
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 32;
-    bmi.bmiHeader.biCompression = BI_RGB;
-
-    void* bits = nullptr;
-    HBITMAP hBitmap = CreateDIBSection(hDC, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
-    
-    HGDIOBJ oldObj = SelectObject(hMemDC, hBitmap);
-    
-    // Clear background (transparent)
-    DrawIconEx(hMemDC, 0, 0, hIcon, width, height, 0, NULL, DI_NORMAL);
-
-    // Now we have the bits in BGRA format (Windows default)
-    // FLTK wants RGBA or RGB.
-    // We need to copy and swap channels.
-    
-    std::vector<unsigned char> rgba_data(width * height * 4);
-    unsigned char* src = static_cast<unsigned char*>(bits);
-    
-    for (int i = 0; i < width * height; ++i) {
-        unsigned char b = src[i * 4 + 0];
-        unsigned char g = src[i * 4 + 1];
-        unsigned char r = src[i * 4 + 2];
-        unsigned char a = src[i * 4 + 3];
-        
-        rgba_data[i * 4 + 0] = r;
-        rgba_data[i * 4 + 1] = g;
-        rgba_data[i * 4 + 2] = b;
-        rgba_data[i * 4 + 3] = a;
+    core::IconBitmap bitmap;
+    if (!SyncProvider().LoadPathIcon(path, large, bitmap)) return nullptr;
+    return ToFlImage(std::move(bitmap));
+}
+
+void IconManager::RequestSpecificIcon(const std::string& path, bool large, const void* owner,
+                                      SpecificIconCallback cb) {
+    core::IconDiskCache& disk = core::IconDiskCache::Get();
+    bool disk_ready = disk.Ready();
+    core::IconBitmap bitmap;
+    bool stale = false;
+    if (disk_ready && disk.Lookup(core::IconDiskCache::PathKey(path), large, bitmap, &stale)) {
+        if (stale) core::IconService::Get().RequestPath(path, large, core::TaskPriority::Indexing);
+        cb(ToFlImage(std::move(bitmap)));
+        return;
+    }
+    SpecificKey key(path, large);
+    auto& waiters = pending_specific[key];
+    waiters.push_back({owner, std::move(cb)});
+    // Later waiters for the same path ride on the first request
+    if (waiters.size() > 1) return;
+    if (disk_ready) {
+        core::IconService::Get().RequestPath(path, large);
+    } else {
+        disk.Open();
+        awaiting_disk_specific.push_back(key);
     }
+}
+
+void IconManager::CancelSpecificIcons(const void* owner) {
+    for (auto& entry : pending_specific) {
+        for (auto& waiter : entry.second) {
+            if (waiter.owner == owner) waiter.cb = nullptr;
+        }
+    }
+}
+
+int IconManager::AddIconsLoadedListener(std::function<void()> cb) {
+    int id = next_listener_id++;
+    listeners[id] = std::move(cb);
+    return id;
+}
 
-    SelectObject(hMemDC, oldObj);
-    DeleteObject(hBitmap);
-    DeleteDC(hMemDC);
-    ReleaseDC(NULL, hDC);
-    DeleteObject(iconInfo.hbmColor);
-    DeleteObject(iconInfo.hbmMask);
-
-    // Create FLTK image (depth 4 for RGBA)
-    Fl_RGB_Image* temp = new Fl_RGB_Image(rgba_data.data(), width, height, 4);
-    Fl_RGB_Image* final_img = (Fl_RGB_Image*)temp->copy(width, height);
-    delete temp;
-    
-    return final_img;
-}
-
-Fl_RGB_Image* IconManager::LoadIconFromSystem(const std::string& path, bool is_dir, bool specific, bool large) {
-    SHFILEINFOA sfi = {0};
-    UINT flags = SHGFI_ICON;
-    if (large) flags |= SHGFI_LARGEICON;
-    else flags |= SHGFI_SMALLICON;
-    
-    std::string lookup_path = path;
-    std::replace(lookup_path.begin(), lookup_path.end(), '/', '\\');
-
-    if (!specific) {
-        // Generic lookup: Use attributes and dummy path
-        flags |= SHGFI_USEFILEATTRIBUTES;
-        DWORD attributes = is_dir ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
-        
-        if (is_dir) {
-            lookup_path = "directory";
-        } else {
-            size_t dot_pos = path.find_last_of('.');
-            if (dot_pos != std::string::npos) {
-                lookup_path = "dummy" + path.substr(dot_pos);
+void IconManager::RemoveIconsLoadedListener(int id) {
+    listeners.erase(id);
+}
+
+void IconManager::ScheduleDrain() {
+    static core::Counter& awakes = core::Metrics::Get().GetCounter("ui.awakes");
+    // Workers finish in bursts; one awake drains everything queued so far
+    if (drain_scheduled.exchange(true)) return;
+    awakes.Add();
+    Fl::awake(DrainCallback, this);
+}
+
+void IconManager::DrainCallback(void* data) {
+    static_cast<IconManager*>(data)->DrainCompleted();
+}
+
+void IconManager::DeliverSpecific(const SpecificKey& key, core::IconBitmap* bitmap) {
+    auto it = pending_specific.find(key);
+    if (it == pending_specific.end()) return;
+    std::vector<PendingSpecific> waiters = std::move(it->second);
+    pending_specific.erase(it);
+    for (size_t w = 0; w < waiters.size(); ++w) {
+        if (!waiters[w].cb) continue; // Owner went away
+        // Each waiter owns its own image; the last one takes the pixels
+        Fl_RGB_Image* img = nullptr;
+        if (bitmap) {
+            bool last = w + 1 == waiters.size();
+            img = last ? ToFlImage(std::move(*bitmap)) : ToFlImage(*bitmap);
+        }
+        waiters[w].cb(img);
+    }
+}
+
+void IconManager::DrainCompleted() {
+    // Clear first: results landing during the drain schedule another one
+    drain_scheduled.store(false);
+    bool types_loaded = false;
+
+    core::IconDiskCache& disk = core::IconDiskCache::Get();
+    if (disk.Ready() && (!awaiting_disk.empty() || !awaiting_disk_specific.empty())) {
+        std::vector<core::IconId> types;
+        types.swap(awaiting_disk);
+        for (core::IconId id : types) LoadType(id);
+        types_loaded = !types.empty();
+
+        std::vector<SpecificKey> paths;
+        paths.swap(awaiting_disk_specific);
+        for (const auto& key : paths) {
+            core::IconBitmap bitmap;
+            bool stale = false;
+            if (disk.Lookup(core::IconDiskCache::PathKey(key.first), key.second, bitmap, &stale)) {
+                if (stale) core::IconService::Get().RequestPath(key.first, key.second, core::TaskPriority::Indexing);
+                DeliverSpecific(key, &bitmap);
             } else {
-                lookup_path = "dummy.dat"; 
+                core::IconService::Get().RequestPath(key.first, key.second);
             }
         }
-        
-        if (SHGetFileInfoA(lookup_path.c_str(), attributes, &sfi, sizeof(sfi), flags)) {
-            Fl_RGB_Image* img = HIconToFlImage(sfi.hIcon);
-            DestroyIcon(sfi.hIcon);
-            return img;
+    }
+
+    for (auto& result : core::IconService::Get().TakeCompleted()) {
+        if (result.ok) {
+            std::string key = result.path.empty() ? core::IconDiskCache::TypeKey(result.id)
+                                                  : core::IconDiskCache::PathKey(result.path);
+            core::IconDiskCache::Get().Store(key, result.large, result.bitmap);
         }
-    } else {
-        // Specific lookup: Use real path, access file
-        if (SHGetFileInfoA(lookup_path.c_str(), 0, &sfi, sizeof(sfi), flags)) {
-            Fl_RGB_Image* img = HIconToFlImage(sfi.hIcon);
-            DestroyIcon(sfi.hIcon);
-            return img;
+        if (result.path.empty()) {
+            Install(result.id, result.ok ? ToFlImage(std::move(result.bitmap)) : nullptr);
+            types_loaded = true;
+            continue;
         }
+        DeliverSpecific(SpecificKey(result.path, result.large), result.ok ? &result.bitmap : nullptr);
     }
 
-    return nullptr;
+    if (types_loaded) {
+        // Copy: a listener may remove itself
+        auto snapshot = listeners;
+        for (auto& entry : snapshot) entry.second();
+    }
 }
+
 }
@@ -1,32 +1,98 @@
 #pragma once
 #include <FL/Fl_RGB_Image.H>
 #include <string>
+#include <atomic>
 #include <map>
-#include <mutex>
+#include <vector>
+#include <functional>
+#include "../core/IconType.h"
+#include "../core/IconProvider.h"
 
 namespace ui {
 
 class IconManager {
 public:
     static IconManager& Get();
-    
-    // Returns a pointer to a cached Fl_RGB_Image.
+
+    // Draw path (UI thread). Returns the cached icon for an interned icon type
+    // (see core::Listing::Icon); once loaded this is two atomic loads with no
+    // lock, hash or allocation. Until then it queues the type on IconService
+    // and returns a placeholder; listeners hear when real icons arrive. While
+    // IconDiskCache is still being mapped the type waits for it instead.
     // Do not delete the returned pointer.
+    Fl_RGB_Image* GetIcon(core::IconId id);
+    bool IsPlaceholder(const Fl_RGB_Image* img) const;
+
+    // Blocking variant for callers off the draw path: loads the type on the
+    // calling thread if nobody has yet
     Fl_RGB_Image* GetIcon(const std::string& path, bool is_dir);
 
-    // Returns a new Fl_RGB_Image for a specific file (not cached).
-    // Caller owns the returned pointer.
+    // Returns a new Fl_RGB_Image for a specific file (not cached), loaded on
+    // the calling thread. Caller owns the returned pointer.
     Fl_RGB_Image* GetSpecificIcon(const std::string& path, bool large = false);
 
+    // Asynchronous GetSpecificIcon: cb runs on the UI thread with a new image
+    // it owns (nullptr if there is none); immediately if the icon is in
+    // IconDiskCache and that is mapped, otherwise once the mapping or the pool
+    // has it. owner identifies the caller for CancelSpecificIcons, which a
+    // widget must call before it dies.
+    using SpecificIconCallback = std::function<void(Fl_RGB_Image*)>;
+    void RequestSpecificIcon(const std::string& path, bool large, const void* owner, SpecificIconCallback cb);
+    void CancelSpecificIcons(const void* owner);
+
+    // Called on the UI thread after queued type icons replaced placeholders
+    int AddIconsLoadedListener(std::function<void()> cb);
+    void RemoveIconsLoadedListener(int id);
+
 private:
-    IconManager() = default;
+    IconManager();
     ~IconManager();
-    
-    // Cache key: extension for files, "DIR" for directories
-    std::map<std::string, Fl_RGB_Image*> icon_cache_;
-    std::mutex cache_mutex_;
-    
-    Fl_RGB_Image* LoadIconFromSystem(const std::string& path, bool is_dir, bool specific, bool large);
+
+    // Flat table indexed by icon id, allocated a chunk at a time. Slots are
+    // filled once and never replaced, so readers can skip locking.
+    static const size_t kChunkSize = 256;
+    struct Chunk {
+        std::atomic<Fl_RGB_Image*> images[kChunkSize];
+        std::atomic<bool> failed[kChunkSize]; // Don't ask the shell again
+        std::atomic<bool> requested[kChunkSize]; // Queued on IconService or awaiting_disk
+        Chunk();
+    };
+    std::atomic<Chunk*> chunks_[core::kMaxIconTypes / kChunkSize];
+    Chunk* GetChunk(core::IconId id);
+    // First image stored in a slot wins; returns the one in the table
+    Fl_RGB_Image* Install(core::IconId id, Fl_RGB_Image* img);
+    // From IconDiskCache if it has the type, else queued on IconService.
+    // The disk cache must be ready.
+    void LoadType(core::IconId id);
+
+    Fl_RGB_Image* folder_placeholder = nullptr;
+    Fl_RGB_Image* file_placeholder = nullptr;
+
+    // UI thread only: filled by RequestSpecificIcon, emptied by the drain
+    struct PendingSpecific {
+        const void* owner;
+        SpecificIconCallback cb;
+    };
+    using SpecificKey = std::pair<std::string, bool>;
+    std::map<SpecificKey, std::vector<PendingSpecific>> pending_specific;
+    // UI thread only: requests that came in before IconDiskCache was mapped,
+    // resolved by the drain once it is
+    std::vector<core::IconId> awaiting_disk;
+    std::vector<SpecificKey> awaiting_disk_specific;
+    std::map<int, std::function<void()>> listeners;
+    int next_listener_id = 1;
+
+    std::atomic<bool> drain_scheduled{false};
+    void ScheduleDrain();
+    static void DrainCallback(void* data);
+    void DrainCompleted();
+    // Hands an icon (nullptr for none) to everyone waiting on key
+    void DeliverSpecific(const SpecificKey& key, core::IconBitmap* bitmap);
 };
 
+// New image over the bitmap's pixels without copying them; the caller owns it
+Fl_RGB_Image* ToFlImage(core::IconBitmap&& bitmap);
+// Same, for a bitmap that must stay intact (one copy)
+Fl_RGB_Image* ToFlImage(const core::IconBitmap& bitmap);
+
 }
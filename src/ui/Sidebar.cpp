@@ -1,16 +1,17 @@
 #include "Sidebar.h"
 #include "IconManager.h"
-#include "../core/QuickAccess.h"
 #include <shlobj.h>
 #include <windows.h>
 #include <iostream>
+#include <unordered_map>
 #include <FL/Fl.H>
 #include <FL/fl_draw.H>
 #include <FL/Fl_Menu_Item.H>
 
 namespace ui {
 
-Sidebar::Sidebar(int x, int y, int w, int h) : Fl_Scroll(x, y, w, h) {
+Sidebar::Sidebar(int x, int y, int w, int h, core::QuickAccess& quick_access)
+    : Fl_Scroll(x, y, w, h), quick_access(quick_access) {
     box(FL_FLAT_BOX);
     color(fl_rgb_color(37, 37, 38)); // #252526 Darker gray
     
@@ -24,17 +25,21 @@ Sidebar::Sidebar(int x, int y, int w, int h) : Fl_Scroll(x, y, w, h) {
     // Hide arrows initially by matching color to track
     scrollbar.labelcolor(fl_rgb_color(37, 37, 38));
     
-    Refresh();
-    
     end();
     
-    // Register callback
-    core::QuickAccess::Get().SetUpdateCallback([this]() {
-        // We need to run this on main thread
+    // Register callback before the first Refresh: the list loads on the pool,
+    // and one that finishes in between must still reach the sidebar
+    quick_access.SetUpdateCallback([this]() {
+        // We need to run this on main thread; visits in a burst share one refresh
+        if (refresh_scheduled.exchange(true)) return;
         Fl::awake([](void* data) {
-            static_cast<Sidebar*>(data)->Refresh();
+            Sidebar* sidebar = static_cast<Sidebar*>(data);
+            sidebar->refresh_scheduled.store(false);
+            sidebar->Refresh();
         }, this);
     });
+
+    Refresh();
 }
 
 Sidebar::SidebarButton::SidebarButton(int x, int y, int w, int h, const char* label)
@@ -86,7 +91,7 @@ int Sidebar::SidebarButton::handle(int event) {
             const ::Fl_Menu_Item* m = menu->popup(Fl::event_x(), Fl::event_y(), 0, 0, 0);
             if (m) {
                 if (strcmp(m->label(), "Unpin from Quick Access") == 0) {
-                    core::QuickAccess::Get().Unpin(path);
+                    static_cast<Sidebar*>(parent())->quick_access.Unpin(path);
                 }
             }
             return 1;
@@ -96,37 +101,65 @@ int Sidebar::SidebarButton::handle(int event) {
 }
 
 void Sidebar::Refresh() {
-    this->begin(); // Ensure buttons are added to this group
+    auto items_list = quick_access.GetItems(100);
 
-    // Clear existing buttons
-    for (auto& item : items) {
-        delete item.btn;
-    }
-    items.clear();
-    
-    // We do NOT clear icon_cache here. We keep it.
-    
-    int cur_y = y() + 10;
-    
-    // Quick Access
-    auto items_list = core::QuickAccess::Get().GetItems(100);
+    // Reuse the buttons of paths still listed; only the rest are touched
+    std::unordered_map<std::string, SidebarButton*> old_buttons;
+    for (auto& item : items) old_buttons.emplace(item.path, item.btn);
+    int old_count = static_cast<int>(items.size());
+
+    std::vector<SidebarItem> next;
+    next.reserve(items_list.size());
+    bool missing_icons = false;
+    int top = y() + 10 - yposition(); // Children are placed in scrolled coordinates
     for (const auto& item : items_list) {
+        if (item.path.empty()) continue;
         std::string label = item.path;
         if (label.back() == '/' || label.back() == '\\') label.pop_back();
         size_t pos = label.find_last_of("/\\");
         if (pos != std::string::npos) label = label.substr(pos + 1);
         if (label.empty()) label = item.path;
-        
-        AddButton(label.c_str(), item.path, cur_y, item.pinned);
+
+        int row_y = top + static_cast<int>(next.size()) * kRowHeight;
+        SidebarButton* btn;
+        auto it = old_buttons.find(item.path);
+        if (it != old_buttons.end()) {
+            btn = it->second;
+            old_buttons.erase(it);
+            bool changed = false;
+            if (btn->pinned != item.pinned) {
+                btn->pinned = item.pinned;
+                changed = true;
+            }
+            if (label != btn->label()) {
+                btn->copy_label(label.c_str());
+                changed = true;
+            }
+            if (btn->y() != row_y) {
+                btn->position(btn->x(), row_y);
+                changed = true;
+            }
+            if (changed) btn->redraw();
+        } else {
+            btn = CreateButton(label.c_str(), item.path, row_y, item.pinned);
+            if (!btn->icon) missing_icons = true;
+        }
+        next.push_back({btn, item.path});
+    }
+
+    for (auto& entry : old_buttons) delete entry.second; // Also removes it from the group
+    items.swap(next);
+
+    // Rows that emptied at the end still show the old buttons
+    int new_count = static_cast<int>(items.size());
+    if (new_count < old_count) {
+        damage(FL_DAMAGE_ALL, x(), top + new_count * kRowHeight, w(), (old_count - new_count) * kRowHeight);
+    }
+
+    // Defer icon loading, for new buttons only
+    if (missing_icons && !Fl::has_timeout(LoadIconsCallback, this)) {
+        Fl::add_timeout(0.1, LoadIconsCallback, this);
     }
-    
-    this->end(); // Stop adding to this group
-    
-    redraw();
-    
-    // Defer icon loading
-    Fl::remove_timeout(LoadIconsCallback, this);
-    Fl::add_timeout(0.1, LoadIconsCallback, this);
 }
 
 Sidebar::~Sidebar() {
@@ -134,17 +167,21 @@ Sidebar::~Sidebar() {
         delete icon;
     }
     icons.clear();
-    core::QuickAccess::Get().SetUpdateCallback(nullptr);
+    Fl::remove_timeout(LoadIconsCallback, this);
+    IconManager::Get().CancelSpecificIcons(this);
+    quick_access.SetUpdateCallback(nullptr);
 }
 
 void Sidebar::SetNavigateCallback(std::function<void(const std::string&)> cb) {
     on_navigate = cb;
 }
 
-void Sidebar::AddButton(const char* label, const std::string& path, int& cur_y, bool pinned) {
-    if (path.empty()) return;
-    
-    SidebarButton* btn = new SidebarButton(x() + 10, cur_y, w() - 25, 30, label);
+Sidebar::SidebarButton* Sidebar::CreateButton(const char* label, const std::string& path, int row_y, bool pinned) {
+    // Created outside whatever group is open, then added here
+    Fl_Group* open_group = Fl_Group::current();
+    Fl_Group::current(nullptr);
+    SidebarButton* btn = new SidebarButton(x() + 10, row_y, w() - 25, kRowHeight - 5, label);
+    Fl_Group::current(open_group);
     btn->copy_label(label);
     btn->pinned = pinned;
     btn->path = path;
@@ -155,17 +192,18 @@ void Sidebar::AddButton(const char* label, const std::string& path, int& cur_y,
         btn->icon = it->second;
     }
     
-    std::string* path_ptr = new std::string(path);
-    btn->callback([](Fl_Widget* w, void* data) {
+    // The button carries its own path, so the callback needs no data
+    btn->callback([](Fl_Widget* w, void*) {
         Sidebar* sidebar = (Sidebar*)w->parent();
-        std::string* p = (std::string*)data;
-        if (sidebar->on_navigate && p) {
-            sidebar->on_navigate(*p);
+        SidebarButton* button = static_cast<SidebarButton*>(w);
+        if (sidebar->on_navigate) {
+            sidebar->on_navigate(button->path);
         }
-    }, path_ptr);
+    });
     
-    items.push_back({btn, path});
-    cur_y += 35;
+    add(btn);
+    btn->redraw();
+    return btn;
 }
 
 void Sidebar::LoadIconsCallback(void* data) {
@@ -187,13 +225,21 @@ void Sidebar::LoadIcons() {
             continue;
         }
         
-        Fl_RGB_Image* icon = IconManager::Get().GetSpecificIcon(item.path);
-        if (icon) {
-            item.btn->icon = icon;
+        // Shell lookups run on the pool; buttons are matched by path on return
+        // since Refresh may have rebuilt them by then
+        if (!icon_requested.insert(item.path).second) continue;
+        std::string path = item.path;
+        IconManager::Get().RequestSpecificIcon(path, false, this, [this, path](Fl_RGB_Image* icon) {
+            icon_requested.erase(path);
+            if (!icon) return;
             icons.push_back(icon); // Take ownership
-            icon_cache[item.path] = icon; // Add to cache
-            item.btn->redraw();
-        }
+            icon_cache[path] = icon; // Add to cache
+            for (auto& item : items) {
+                if (item.path != path) continue;
+                item.btn->icon = icon;
+                item.btn->redraw();
+            }
+        });
     }
 }
 
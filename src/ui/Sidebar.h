@@ -6,15 +6,20 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <set>
+#include <atomic>
+#include "../core/QuickAccess.h"
 
 namespace ui {
 
 class Sidebar : public Fl_Scroll {
 public:
-    Sidebar(int x, int y, int w, int h);
+    Sidebar(int x, int y, int w, int h, core::QuickAccess& quick_access = core::QuickAccess::Get());
     ~Sidebar();
     
     void SetNavigateCallback(std::function<void(const std::string&)> cb);
+    // Diffs QuickAccess items against the current buttons: moves, adds and
+    // removes only the rows that changed and redraws just those
     void Refresh();
     int handle(int event) override;
 
@@ -34,16 +39,20 @@ private:
         std::string path;
     };
 
-    void AddButton(const char* label, const std::string& path, int& cur_y, bool pinned);
+    static const int kRowHeight = 35;
+    SidebarButton* CreateButton(const char* label, const std::string& path, int row_y, bool pinned);
     std::string GetKnownFolderPath(const void* rfid);
     
     void LoadIcons();
     static void LoadIconsCallback(void* data);
 
+    core::QuickAccess& quick_access;
     std::function<void(const std::string&)> on_navigate;
     std::vector<SidebarItem> items;
     std::vector<Fl_RGB_Image*> icons; // Still needed for ownership if not in cache?
     std::map<std::string, Fl_RGB_Image*> icon_cache;
+    std::set<std::string> icon_requested; // Paths with a lookup in flight
+    std::atomic<bool> refresh_scheduled{false};
 };
 
 }
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "core/DirectoryEnumerator.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <map>
+
+namespace fs = std::filesystem;
+
+class DirectoryEnumeratorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root = fs::temp_directory_path() / "flash_enum_test";
+        fs::remove_all(root);
+        fs::create_directories(root / "subdir");
+        std::ofstream(root / "empty.txt");
+        std::ofstream(root / "data.bin") << std::string(1500, 'x');
+    }
+
+    void TearDown() override {
+        fs::remove_all(root);
+    }
+
+    std::map<std::string, core::DirEntryInfo> Collect(core::DirectoryEnumerator& e) {
+        std::map<std::string, core::DirEntryInfo> out;
+        std::string error;
+        bool ok = e.Enumerate(root.string(), [&](const std::vector<core::DirEntryInfo>& batch) {
+            for (const auto& info : batch) out[info.name] = info;
+            return true;
+        }, error);
+        EXPECT_TRUE(ok) << error;
+        return out;
+    }
+
+    fs::path root;
+};
+
+TEST_F(DirectoryEnumeratorTest, ReportsTypesAndSizes) {
+    auto enumerator = core::CreateDirectoryEnumerator();
+    auto entries = Collect(*enumerator);
+
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_TRUE(entries["subdir"].is_dir);
+    EXPECT_FALSE(entries["data.bin"].is_dir);
+    EXPECT_TRUE(entries["data.bin"].size_known);
+    EXPECT_EQ(entries["data.bin"].size, 1500u);
+    EXPECT_EQ(entries["empty.txt"].size, 0u);
+    EXPECT_GT(entries["data.bin"].mtime, 0);
+}
+
+TEST_F(DirectoryEnumeratorTest, MatchesStdBackend) {
+    auto fast = core::CreateDirectoryEnumerator();
+    auto reference = core::CreateStdDirectoryEnumerator();
+    auto a = Collect(*fast);
+    auto b = Collect(*reference);
+
+    ASSERT_EQ(a.size(), b.size());
+    for (const auto& pair : b) {
+        ASSERT_TRUE(a.count(pair.first)) << pair.first;
+        EXPECT_EQ(a[pair.first].is_dir, pair.second.is_dir);
+        EXPECT_EQ(a[pair.first].size, pair.second.size);
+    }
+}
+
+TEST_F(DirectoryEnumeratorTest, MissingDirectoryFails) {
+    auto enumerator = core::CreateDirectoryEnumerator();
+    std::string error;
+    bool ok = enumerator->Enumerate((root / "does_not_exist").string(),
+        [](const std::vector<core::DirEntryInfo>&) { return true; }, error);
+    EXPECT_FALSE(ok);
+    EXPECT_FALSE(error.empty());
+}
+
+TEST_F(DirectoryEnumeratorTest, StopsWhenCallbackReturnsFalse) {
+    for (int i = 0; i < 2000; ++i) {
+        std::ofstream(root / ("f" + std::to_string(i)));
+    }
+    auto enumerator = core::CreateDirectoryEnumerator();
+    std::string error;
+    int batches = 0;
+    bool ok = enumerator->Enumerate(root.string(), [&](const std::vector<core::DirEntryInfo>&) {
+        batches++;
+        return false;
+    }, error);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(batches, 1);
+}
+
+TEST_F(DirectoryEnumeratorTest, StatNamesSkipsMissing) {
+    for (auto& enumerator : {core::CreateDirectoryEnumerator(), core::CreateStdDirectoryEnumerator()}) {
+        auto infos = enumerator->StatNames(root.string(), {"data.bin", "nope.txt", "subdir"});
+        ASSERT_EQ(infos.size(), 2u) << enumerator->Name();
+        EXPECT_EQ(infos[0].name, "data.bin");
+        EXPECT_EQ(infos[0].size, 1500u);
+        EXPECT_TRUE(infos[0].size_known);
+        EXPECT_TRUE(infos[1].is_dir);
+    }
+}
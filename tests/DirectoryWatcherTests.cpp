@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "core/DirectoryWatcher.h"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace fs = std::filesystem;
+using Clock = core::ChangeCoalescer::Clock;
+using std::chrono::milliseconds;
+
+TEST(DirectoryWatcherTests, CoalescerWaitsForQuietThenDeliversOnce) {
+    core::ChangeCoalescer pending;
+    auto t0 = Clock::now();
+    EXPECT_EQ(pending.TimeoutMs(t0), -1);
+
+    for (int i = 0; i < 100; ++i) pending.Add("a.txt", t0 + milliseconds(i / 10));
+    pending.Add("b.txt", t0 + milliseconds(10));
+
+    int deliveries = 0;
+    core::WatchChanges seen;
+    auto record = [&](const core::WatchChanges& changes) { deliveries++; seen = changes; return true; };
+
+    pending.DeliverIfDue(record, t0 + milliseconds(20));
+    EXPECT_EQ(deliveries, 0);
+    EXPECT_GT(pending.TimeoutMs(t0 + milliseconds(20)), 0);
+
+    pending.DeliverIfDue(record, t0 + milliseconds(100));
+    EXPECT_EQ(deliveries, 1);
+    EXPECT_EQ(std::set<std::string>(seen.names.begin(), seen.names.end()), (std::set<std::string>{"a.txt", "b.txt"}));
+    EXPECT_FALSE(pending.HasPending());
+}
+
+TEST(DirectoryWatcherTests, CoalescerBoundsDelayAndKeepsRefusedBursts) {
+    core::ChangeCoalescer pending;
+    auto t0 = Clock::now();
+    // Never quiet, but still delivered within the max delay
+    for (int ms = 0; ms <= 300; ms += 10) pending.Add("log" + std::to_string(ms), t0 + milliseconds(ms));
+    EXPECT_EQ(pending.TimeoutMs(t0 + milliseconds(300)), 0);
+
+    pending.DeliverIfDue([](const core::WatchChanges&) { return false; }, t0 + milliseconds(300));
+    EXPECT_TRUE(pending.HasPending());
+
+    size_t delivered = 0;
+    pending.DeliverIfDue([&](const core::WatchChanges& c) { delivered = c.names.size(); return true; }, t0 + milliseconds(500));
+    EXPECT_EQ(delivered, 31u);
+}
+
+TEST(DirectoryWatcherTests, CoalescerTurnsFloodsIntoOverflow) {
+    core::ChangeCoalescer pending;
+    auto t0 = Clock::now();
+    for (int i = 0; i < 10000; ++i) pending.Add("obj" + std::to_string(i), t0);
+
+    core::WatchChanges seen;
+    pending.DeliverIfDue([&](const core::WatchChanges& c) { seen = c; return true; }, t0 + milliseconds(300));
+    EXPECT_TRUE(seen.overflow);
+    EXPECT_TRUE(seen.names.empty());
+}
+
+#if defined(__linux__) || defined(_WIN32)
+TEST(DirectoryWatcherTests, ReportsCreatedAndDeletedFilesInFewBursts) {
+    fs::path root = fs::temp_directory_path() / "flash_watch_test";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    std::ofstream(root / "old.txt");
+
+    std::mutex mutex;
+    std::set<std::string> names;
+    int bursts = 0;
+
+    auto watcher = core::CreateDirectoryWatcher();
+    std::string error;
+    ASSERT_TRUE(watcher->Start(root.string(), [&](const core::WatchChanges& changes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bursts++;
+        names.insert(changes.names.begin(), changes.names.end());
+        return true;
+    }, error)) << error;
+
+    for (int i = 0; i < 200; ++i) std::ofstream(root / ("new" + std::to_string(i) + ".txt"));
+    fs::remove(root / "old.txt");
+
+    for (int waited = 0; waited < 2000; waited += 10) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (names.size() >= 201) break;
+        }
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    watcher->Stop();
+
+    EXPECT_TRUE(names.count("old.txt"));
+    EXPECT_TRUE(names.count("new199.txt"));
+    EXPECT_LE(bursts, 5);
+    fs::remove_all(root);
+}
+#endif
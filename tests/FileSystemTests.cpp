@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "core/FileSystem.h"
+#include <filesystem>
+#include <fstream>
 
 TEST(FileSystemTests, FormatSize_Bytes) {
     EXPECT_EQ(core::FormatSize(0), "0 B");
@@ -17,3 +19,43 @@ TEST(FileSystemTests, FormatSize_Megabytes) {
     EXPECT_EQ(core::FormatSize(1024 * 1024), "1.0 MB");
     EXPECT_EQ(core::FormatSize(1024 * 1024 * 2.5), "2.5 MB");
 }
+
+TEST(FileSystemTests, FormatSize_BufferMatchesString) {
+    char buf[32];
+    size_t n = core::FormatSize(1536, buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, n), "1.5 KB");
+    EXPECT_EQ(std::string(buf), core::FormatSize(1536));
+
+    // Truncates instead of overflowing
+    char tiny[4];
+    n = core::FormatSize(1536, tiny, sizeof(tiny));
+    EXPECT_EQ(n, 3u);
+    EXPECT_STREQ(tiny, "1.5");
+}
+
+TEST(FileSystemTests, FormatTime_UnknownIsEmpty) {
+    char buf[32];
+    EXPECT_EQ(core::FormatTime(0, buf, sizeof(buf)), 0u);
+    EXPECT_STREQ(buf, "");
+    EXPECT_GT(core::FormatTime(1700000000, buf, sizeof(buf)), 0u);
+}
+
+TEST(FileSystemTests, WriteFileReplacing) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "flash_replace_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string path = (dir / "data.bin").string();
+
+    ASSERT_TRUE(core::WriteFileReplacing(path, "first"));
+    ASSERT_TRUE(core::WriteFileReplacing(path, std::string("sec\0nd", 6)));
+    std::ifstream in(path, std::ios::binary);
+    std::string read((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(read, std::string("sec\0nd", 6));
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+
+    // A missing folder fails without leaving anything behind
+    EXPECT_FALSE(core::WriteFileReplacing((dir / "missing" / "data.bin").string(), "x"));
+    in.close();
+    fs::remove_all(dir);
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "core/FileSystem.h"
+#include "core/ListingCache.h"
+#include "core/ListingSpill.h"
+#include "core/Session.h"
+#include "core/TabContext.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class HibernationTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "flash_hibernation_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir / "folder");
+        for (const char* name : {"a.txt", "b.txt"}) std::ofstream(dir / "folder" / name) << name;
+        spill = (dir / "tab.bin").string();
+        context = std::make_shared<core::TabContext>();
+    }
+    void TearDown() override {
+        context->generation++;
+        core::StopWatching(context);
+        fs::remove_all(dir);
+    }
+
+    // Shows listing in the hidden tab as a finished load of its parent would
+    void Show(std::shared_ptr<const core::Listing> listing) {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        context->current_path = listing->Parent();
+        context->is_active = false;
+        context->Publish(core::ListingSnapshot::Make(listing, nullptr, core::SortSpec(), 1));
+    }
+
+    bool WaitFor(std::function<bool()> done) {
+        for (int i = 0; i < 500; ++i) {
+            if (done()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return done();
+    }
+
+    bool Hibernated() {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        return !context->hibernation_file.empty();
+    }
+
+    bool HasRow(const std::string& name) {
+        auto snapshot = context->Snapshot();
+        for (size_t r = 0; r < snapshot->size(); ++r) {
+            size_t i;
+            if (snapshot->Row(r, i).Name(i) == name) return true;
+        }
+        return false;
+    }
+
+    fs::path dir;
+    std::string spill;
+    std::shared_ptr<core::TabContext> context;
+};
+
+}
+
+TEST_F(HibernationTests, SpillKeepsListingsPastTheSessionCap) {
+    core::Listing listing("/big");
+    size_t count = core::kMaxSessionEntries + 1;
+    listing.reserve(count, count * 12);
+    for (size_t i = 0; i < count; ++i) listing.Append("file" + std::to_string(i) + ".txt", i % 100 == 0, i, true, 1700000000);
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(count - 1 - i);
+    core::SortSpec spec{core::SortColumn::Size, false};
+    ASSERT_TRUE(core::WriteListingSpill(spill, listing, &order, spec));
+
+    core::SpilledListing out;
+    ASSERT_TRUE(core::ReadListingSpill(spill, out));
+    ASSERT_EQ(out.listing->size(), count);
+    EXPECT_EQ(out.listing->Parent(), "/big");
+    EXPECT_EQ(out.listing->Name(count - 1), listing.Name(count - 1));
+    EXPECT_EQ(out.listing->Key(7), listing.Key(7));
+    EXPECT_EQ(out.listing->Icon(7), listing.Icon(7));
+    EXPECT_TRUE(out.listing->IsDir(100));
+    ASSERT_TRUE(out.order);
+    EXPECT_EQ(*out.order, order);
+    EXPECT_TRUE(out.spec == spec);
+
+    fs::resize_file(spill, fs::file_size(spill) - 3);
+    EXPECT_FALSE(core::ReadListingSpill(spill, out));
+
+    // A count far past what the file holds is refused before reserving for it
+    {
+        std::fstream file(spill, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(8); // Magic and version come first
+        uint32_t huge = UINT32_MAX;
+        file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    EXPECT_FALSE(core::ReadListingSpill(spill, out));
+}
+
+TEST_F(HibernationTests, WakeShowsTheListingAndPicksUpChanges) {
+    std::string folder = (dir / "folder").string();
+    auto listing = std::make_shared<core::Listing>(folder);
+    listing->Append("a.txt", false, 5, true);
+    listing->Append("b.txt", false, 5, true);
+    Show(listing);
+
+    core::HibernateTab(context, spill);
+    ASSERT_TRUE(WaitFor([&]() { return Hibernated(); }));
+    EXPECT_TRUE(context->Snapshot()->empty());
+    EXPECT_TRUE(fs::exists(spill));
+
+    std::ofstream(dir / "folder" / "c.txt") << "c"; // While asleep
+    context->is_active = true;
+    ASSERT_TRUE(core::WakeTab(context));
+    EXPECT_FALSE(context->Snapshot()->empty());
+    EXPECT_FALSE(fs::exists(spill));
+    EXPECT_FALSE(core::WakeTab(context));
+
+    ASSERT_TRUE(WaitFor([&]() { return !context->is_loading; }));
+    EXPECT_TRUE(HasRow("c.txt"));
+    EXPECT_EQ(context->Snapshot()->size(), 3u);
+}
+
+TEST_F(HibernationTests, WakeRestoresListingsPastTheSessionCap) {
+    // More rows than the folder has: anything read from disk would show
+    auto listing = std::make_shared<core::Listing>((dir / "folder").string());
+    size_t count = core::kMaxSessionEntries + 1;
+    listing->reserve(count, count * 12);
+    for (size_t i = 0; i < count; ++i) listing->Append("file" + std::to_string(i), false, i, true);
+    Show(listing);
+
+    core::HibernateTab(context, spill);
+    ASSERT_TRUE(WaitFor([&]() { return Hibernated(); }));
+    context->is_active = true;
+    ASSERT_TRUE(core::WakeTab(context));
+    EXPECT_EQ(context->Snapshot()->size(), count);
+
+    // The folder did not change, so revalidation keeps the restored rows
+    ASSERT_TRUE(WaitFor([&]() { return !context->is_loading; }));
+    EXPECT_EQ(context->Snapshot()->size(), count);
+}
+
+TEST_F(HibernationTests, ShownTabsAreNotHibernated) {
+    auto listing = std::make_shared<core::Listing>((dir / "folder").string());
+    listing->Append("a.txt", false, 5, true);
+    Show(listing);
+    context->is_active = true;
+
+    core::HibernateTab(context, spill);
+    ASSERT_TRUE(WaitFor([&]() {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        return !context->hibernation_queued;
+    }));
+    EXPECT_FALSE(Hibernated());
+    EXPECT_EQ(context->Snapshot()->size(), 1u);
+    EXPECT_FALSE(fs::exists(spill));
+}
+
+TEST_F(HibernationTests, HibernatingDropsTheCachedCopy) {
+    std::string folder = (dir / "folder").string();
+    auto listing = std::make_shared<core::Listing>(folder);
+    listing->Append("a.txt", false, 5, true);
+    listing->Append("b.txt", false, 5, true);
+    Show(listing);
+    core::ListingCache::Get().Store(folder, {listing, nullptr, core::SortSpec(), core::DirectoryChangeStamp(folder)});
+
+    // Otherwise the cache would keep alive what the spill was meant to free
+    core::HibernateTab(context, spill);
+    ASSERT_TRUE(WaitFor([&]() { return Hibernated(); }));
+    core::ListingCache::Entry cached;
+    EXPECT_FALSE(core::ListingCache::Get().Lookup(folder, cached));
+    EXPECT_EQ(listing.use_count(), 1);
+
+    // Waking does not store a copy of its own; revalidation may share the tab's
+    context->is_active = true;
+    ASSERT_TRUE(core::WakeTab(context));
+    ASSERT_TRUE(WaitFor([&]() { return !context->is_loading; }));
+    auto snapshot = context->Snapshot();
+    ASSERT_TRUE(snapshot->Single());
+    EXPECT_EQ(snapshot->size(), 2u);
+    if (core::ListingCache::Get().Lookup(folder, cached)) {
+        EXPECT_EQ(cached.listing, snapshot->parts[0]);
+    }
+}
+
+TEST_F(HibernationTests, WakeRejectsASpillOfAnotherFolder) {
+    auto listing = std::make_shared<core::Listing>((dir / "folder").string());
+    listing->Append("a.txt", false, 5, true);
+    listing->Append("b.txt", false, 5, true);
+    Show(listing);
+    core::HibernateTab(context, spill);
+    ASSERT_TRUE(WaitFor([&]() { return Hibernated(); }));
+
+    // Overwritten by another instance with its own tab's listing
+    core::Listing foreign((dir / "elsewhere").string());
+    for (const char* name : {"x.txt", "y.txt", "z.txt"}) foreign.Append(name, false, 1, true);
+    ASSERT_TRUE(core::WriteListingSpill(spill, foreign, nullptr, core::SortSpec()));
+
+    context->is_active = true;
+    ASSERT_TRUE(core::WakeTab(context));
+    ASSERT_TRUE(WaitFor([&]() { return !context->is_loading; }));
+    EXPECT_EQ(context->Snapshot()->size(), 2u);
+    EXPECT_TRUE(HasRow("a.txt"));
+    EXPECT_FALSE(HasRow("x.txt"));
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "core/IconDiskCache.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class IconDiskCacheTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = (fs::temp_directory_path() / "flash_icon_cache_test.bin").string();
+        fs::remove(path);
+    }
+    void TearDown() override { fs::remove(path); }
+
+    core::IconBitmap Bitmap(int size, uint8_t fill) {
+        core::IconBitmap bitmap;
+        bitmap.Allocate(size, size);
+        std::memset(bitmap.rgba.get(), fill, bitmap.ByteSize());
+        return bitmap;
+    }
+
+    std::string path;
+};
+
+}
+
+TEST_F(IconDiskCacheTests, RoundTripsThroughTheFile) {
+    core::IconId txt = core::InternIconType("a.txt", false);
+    {
+        core::IconDiskCache cache(path);
+        core::IconBitmap out;
+        EXPECT_FALSE(cache.Lookup(core::IconDiskCache::TypeKey(txt), false, out));
+        cache.Store(core::IconDiskCache::TypeKey(txt), false, Bitmap(16, 7));
+        cache.Store(core::IconDiskCache::TypeKey(txt), true, Bitmap(32, 9));
+        cache.Store(core::IconDiskCache::PathKey("/home/user/"), false, Bitmap(16, 3));
+        ASSERT_TRUE(cache.Flush());
+    }
+
+    // A new instance stands in for the next launch
+    core::IconDiskCache cache(path);
+    EXPECT_EQ(cache.EntryCount(), 3u);
+    core::IconBitmap small, large, folder;
+    ASSERT_TRUE(cache.Lookup(core::IconDiskCache::TypeKey(txt), false, small));
+    ASSERT_TRUE(cache.Lookup(core::IconDiskCache::TypeKey(txt), true, large));
+    ASSERT_TRUE(cache.Lookup(core::IconDiskCache::PathKey("/home/user"), false, folder));
+    EXPECT_EQ(small.width, 16);
+    EXPECT_EQ(large.width, 32);
+    EXPECT_EQ(small.rgba[0], 7);
+    EXPECT_EQ(large.rgba[large.ByteSize() - 1], 9);
+    EXPECT_EQ(folder.rgba[5], 3);
+
+    // Replacing the file while entries came from its mapping keeps them
+    cache.Store("type:.md", false, Bitmap(16, 1));
+    ASSERT_TRUE(cache.Flush());
+    EXPECT_TRUE(cache.Lookup(core::IconDiskCache::TypeKey(txt), false, small));
+    EXPECT_EQ(core::IconDiskCache(path).EntryCount(), 4u);
+}
+
+TEST_F(IconDiskCacheTests, ForeignOrTruncatedFilesReadAsEmpty) {
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not an icon cache at all";
+    }
+    EXPECT_EQ(core::IconDiskCache(path).EntryCount(), 0u);
+
+    {
+        core::IconDiskCache cache(path);
+        cache.Store("type:.a", false, Bitmap(16, 1));
+        cache.Store("type:.b", false, Bitmap(16, 2));
+        ASSERT_TRUE(cache.Flush());
+    }
+    fs::resize_file(path, fs::file_size(path) - 10);
+    EXPECT_EQ(core::IconDiskCache(path).EntryCount(), 1u);
+}
+
+TEST_F(IconDiskCacheTests, LookupsMissUntilThePoolHasMappedTheFile) {
+    {
+        core::IconDiskCache cache(path);
+        cache.Store("type:.a", false, Bitmap(16, 1));
+        ASSERT_TRUE(cache.Flush());
+    }
+
+    core::IconDiskCache cache(path);
+    core::IconBitmap out;
+    EXPECT_FALSE(cache.Ready());
+    EXPECT_FALSE(cache.Lookup("type:.a", false, out)); // Queues the load instead of doing it
+    for (int i = 0; i < 500 && !cache.Ready(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(cache.Ready());
+    EXPECT_TRUE(cache.Lookup("type:.a", false, out));
+}
+
+TEST_F(IconDiskCacheTests, OldEntriesStillHitButAreReportedStaleOnce) {
+    {
+        core::IconDiskCache cache(path);
+        cache.Store("type:.a", false, Bitmap(16, 1));
+        ASSERT_TRUE(cache.Flush());
+    }
+    // Backdate the one record: file header (16 bytes), then its written field
+    int64_t written = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - core::IconDiskCache::kStaleSeconds - 60;
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(16 + 8);
+        file.write(reinterpret_cast<const char*>(&written), sizeof(written));
+    }
+
+    core::IconDiskCache cache(path);
+    cache.Load();
+    core::IconBitmap out;
+    bool stale = false;
+    ASSERT_TRUE(cache.Lookup("type:.a", false, out, &stale));
+    EXPECT_TRUE(stale);
+    EXPECT_EQ(out.rgba[0], 1);
+    ASSERT_TRUE(cache.Lookup("type:.a", false, out, &stale));
+    EXPECT_FALSE(stale); // Already being revalidated
+
+    // What the shell says now replaces it
+    cache.Store("type:.a", false, Bitmap(16, 2));
+    ASSERT_TRUE(cache.Flush());
+    core::IconDiskCache next(path);
+    next.Load();
+    ASSERT_TRUE(next.Lookup("type:.a", false, out, &stale));
+    EXPECT_FALSE(stale);
+    EXPECT_EQ(out.rgba[0], 2);
+}
+
+TEST_F(IconDiskCacheTests, ReadyCallbackRunsOnceMapped) {
+    core::IconDiskCache cache(path);
+    std::atomic<int> calls{0};
+    cache.SetReadyCallback([&]() { calls++; });
+    EXPECT_EQ(calls.load(), 0);
+    cache.Open();
+    for (int i = 0; i < 500 && calls == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_TRUE(cache.Ready());
+    EXPECT_EQ(calls.load(), 1);
+
+    // Someone listening only now still hears about it
+    std::atomic<int> late{0};
+    cache.SetReadyCallback([&]() { late++; });
+    EXPECT_EQ(late.load(), 1);
+    cache.SetReadyCallback(nullptr);
+}
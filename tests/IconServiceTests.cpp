@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "core/IconService.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Stub pixels, but every lookup waits for the test to open the gate
+class GatedProvider : public core::StubIconProvider {
+public:
+    std::mutex m;
+    std::condition_variable cv;
+    bool open = false;
+    std::atomic<int> calls{0};
+
+    bool LoadTypeIcon(core::IconId id, bool large, core::IconBitmap& out) override {
+        Wait();
+        return StubIconProvider::LoadTypeIcon(id, large, out);
+    }
+    bool LoadPathIcon(const std::string& path, bool large, core::IconBitmap& out) override {
+        Wait();
+        return StubIconProvider::LoadPathIcon(path, large, out);
+    }
+    void Open() {
+        std::lock_guard<std::mutex> lock(m);
+        open = true;
+        cv.notify_all();
+    }
+
+private:
+    void Wait() {
+        calls++;
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this]() { return open; });
+    }
+};
+
+std::vector<core::IconResult> WaitForResults(core::IconService& service, size_t count) {
+    std::vector<core::IconResult> results;
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (results.size() < count && std::chrono::steady_clock::now() < deadline) {
+        for (auto& r : service.TakeCompleted()) results.push_back(std::move(r));
+        std::this_thread::sleep_for(1ms);
+    }
+    return results;
+}
+
+}
+
+TEST(IconServiceTests, StubProviderDrawsBothShapes) {
+    core::StubIconProvider provider;
+    core::IconBitmap folder, file;
+    ASSERT_TRUE(provider.LoadTypeIcon(core::kIconFolder, false, folder));
+    ASSERT_TRUE(provider.LoadPathIcon("/tmp/notes.txt", true, file));
+    EXPECT_EQ(folder.width, 16);
+    EXPECT_EQ(file.width, 32);
+    EXPECT_EQ(file.ByteSize(), 32u * 32u * 4u);
+    EXPECT_TRUE(std::any_of(folder.rgba.get(), folder.rgba.get() + folder.ByteSize(),
+                            [](uint8_t b) { return b != 0; }));
+}
+
+TEST(IconServiceTests, MergesDuplicateRequestsAndNotifies) {
+    core::TaskScheduler scheduler(2);
+    auto provider = std::make_unique<GatedProvider>();
+    GatedProvider* gate = provider.get();
+    core::IconService service(std::move(provider), scheduler);
+
+    std::atomic<int> wakeups{0};
+    service.SetReadyCallback([&]() { wakeups++; });
+
+    core::IconId txt = core::InternIconType("a.txt", false);
+    EXPECT_TRUE(service.RequestType(txt, false));
+    EXPECT_FALSE(service.RequestType(txt, false)); // Still in flight
+    EXPECT_TRUE(service.RequestType(txt, true)); // Other size is another icon
+    EXPECT_TRUE(service.RequestPath("/some/dir", false));
+    EXPECT_EQ(service.PendingCount(), 3u);
+
+    gate->Open();
+    auto results = WaitForResults(service, 3);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(gate->calls.load(), 3);
+    EXPECT_GE(wakeups.load(), 1);
+    for (const auto& r : results) {
+        EXPECT_TRUE(r.ok);
+        EXPECT_EQ(r.bitmap.width, core::IconSize(r.large));
+    }
+    EXPECT_EQ(service.PendingCount(), 0u);
+
+    // Done requests can be asked again
+    EXPECT_TRUE(service.RequestType(txt, false));
+    EXPECT_EQ(WaitForResults(service, 1).size(), 1u);
+}
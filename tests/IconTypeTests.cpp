@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "core/IconType.h"
+#include "core/Listing.h"
+#include <thread>
+#include <vector>
+
+TEST(IconTypeTests, FoldersAndExtensionlessFilesAreFixed) {
+    EXPECT_EQ(core::InternIconType("src", true), core::kIconFolder);
+    EXPECT_EQ(core::InternIconType("archive.tar.gz", true), core::kIconFolder);
+    EXPECT_EQ(core::InternIconType("README", false), core::kIconGenericFile);
+    EXPECT_EQ(core::InternIconType(".gitignore", false), core::kIconGenericFile);
+    EXPECT_EQ(core::InternIconType("name.averyveryverylongsuffix", false), core::kIconGenericFile);
+}
+
+TEST(IconTypeTests, SameExtensionSameIdIgnoringCase) {
+    core::IconId txt = core::InternIconType("a.txt", false);
+    EXPECT_EQ(core::InternIconType("B.TXT", false), txt);
+    EXPECT_NE(core::InternIconType("c.md", false), txt);
+    EXPECT_EQ(core::IconTypeExtension(txt), ".txt");
+    EXPECT_GT(txt, core::kIconGenericFile);
+}
+
+TEST(IconTypeTests, IdsAgreeAcrossThreads) {
+    std::vector<core::IconId> ids(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ids.size(); ++t) {
+        threads.emplace_back([&ids, t]() { ids[t] = core::InternIconType("shared.xyz", false); });
+    }
+    for (auto& thread : threads) thread.join();
+    for (auto id : ids) EXPECT_EQ(id, ids[0]);
+}
+
+TEST(IconTypeTests, ListingResolvesIconsOnAppend) {
+    core::Listing listing("root");
+    listing.Append("photo.JPG", false, 1, true);
+    listing.Append("photos", true, 0, false);
+
+    core::Listing copy("root");
+    copy.Append(listing, 0, 2);
+    EXPECT_EQ(copy.Icon(0), core::InternIconType("x.jpg", false));
+    EXPECT_EQ(copy.Icon(1), core::kIconFolder);
+}
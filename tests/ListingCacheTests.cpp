@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "core/ListingCache.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+core::ListingCache::Entry MakeEntry(size_t entries) {
+    auto listing = std::make_shared<core::Listing>("root");
+    for (size_t i = 0; i < entries; ++i) listing->Append("f" + std::to_string(i), false, i, true);
+    core::ListingCache::Entry entry;
+    entry.listing = listing;
+    entry.stamp = 42;
+    return entry;
+}
+
+}
+
+TEST(ListingCacheTests, CanonicalKeyNormalizesSeparators) {
+    EXPECT_EQ(core::ListingCache::CanonicalKey("/tmp/a/"), "/tmp/a");
+    EXPECT_EQ(core::ListingCache::CanonicalKey("/"), "/");
+    EXPECT_EQ(core::ListingCache::CanonicalKey("C:\\Users\\"), core::ListingCache::CanonicalKey("C:/Users"));
+    EXPECT_EQ(core::ListingCache::CanonicalKey("C:"), core::ListingCache::CanonicalKey("C:/"));
+}
+
+TEST(ListingCacheTests, HitAndMiss) {
+    core::ListingCache cache(1 << 20);
+    core::ListingCache::Entry out;
+    EXPECT_FALSE(cache.Lookup("/a", out));
+
+    cache.Store("/a/", MakeEntry(10));
+    ASSERT_TRUE(cache.Lookup("/a", out));
+    EXPECT_EQ(out.listing->size(), 10u);
+    EXPECT_EQ(out.stamp, 42);
+
+    cache.Invalidate("/a");
+    EXPECT_FALSE(cache.Lookup("/a", out));
+    EXPECT_EQ(cache.MemoryUsage(), 0u);
+}
+
+TEST(ListingCacheTests, EvictsLeastRecentlyUsedOverBudget) {
+    size_t one = MakeEntry(1000).listing->MemoryUsage();
+    core::ListingCache cache(one * 2 + one / 2);
+
+    cache.Store("/a", MakeEntry(1000));
+    cache.Store("/b", MakeEntry(1000));
+    core::ListingCache::Entry out;
+    ASSERT_TRUE(cache.Lookup("/a", out)); // /b is now the oldest
+    cache.Store("/c", MakeEntry(1000));
+
+    EXPECT_TRUE(cache.Lookup("/a", out));
+    EXPECT_FALSE(cache.Lookup("/b", out));
+    EXPECT_TRUE(cache.Lookup("/c", out));
+    EXPECT_LE(cache.MemoryUsage(), one * 2 + one / 2);
+}
+
+TEST(ListingCacheTests, ChangeStampMovesWhenEntriesChange) {
+    fs::path dir = fs::temp_directory_path() / "flash_cache_stamp";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    int64_t before = core::DirectoryChangeStamp(dir.string());
+    EXPECT_NE(before, 0);
+
+    // Make the change visible even on coarse-grained timestamps
+    fs::last_write_time(dir, fs::last_write_time(dir) - std::chrono::seconds(10));
+    before = core::DirectoryChangeStamp(dir.string());
+    std::ofstream(dir / "new.txt");
+    EXPECT_NE(core::DirectoryChangeStamp(dir.string()), before);
+
+    fs::remove_all(dir);
+    EXPECT_EQ(core::DirectoryChangeStamp(dir.string()), 0);
+}
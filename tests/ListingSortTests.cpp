@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "core/ListingSort.h"
+#include <chrono>
+#include <random>
+
+namespace {
+
+std::vector<std::string> Names(const core::Listing& files, const std::vector<uint32_t>& order) {
+    std::vector<std::string> out;
+    for (uint32_t i : order) out.emplace_back(files.Name(i));
+    return out;
+}
+
+core::Listing Sample() {
+    core::Listing files("root");
+    files.Append("beta.txt", false, 300, true, 20);
+    files.Append("Alpha.doc", false, 100, true, 30);
+    files.Append("zeta", true, 0, false, 10);
+    files.Append("gamma.bin", false, 200, true, 10);
+    files.Append("Docs", true, 0, false, 40);
+    return files;
+}
+
+}
+
+TEST(ListingSortTests, NameFoldersFirstCaseInsensitive) {
+    auto files = Sample();
+    std::vector<uint32_t> order;
+    core::SortListing(files, {core::SortColumn::Name, true}, order);
+    EXPECT_EQ(Names(files, order), (std::vector<std::string>{"Docs", "zeta", "Alpha.doc", "beta.txt", "gamma.bin"}));
+}
+
+TEST(ListingSortTests, DescendingKeepsFoldersOnTop) {
+    auto files = Sample();
+    std::vector<uint32_t> order;
+    core::SortListing(files, {core::SortColumn::Name, false}, order);
+    EXPECT_EQ(Names(files, order), (std::vector<std::string>{"zeta", "Docs", "gamma.bin", "beta.txt", "Alpha.doc"}));
+}
+
+TEST(ListingSortTests, SizeTypeAndDate) {
+    auto files = Sample();
+    std::vector<uint32_t> order;
+
+    core::SortListing(files, {core::SortColumn::Size, true}, order);
+    EXPECT_EQ(Names(files, order), (std::vector<std::string>{"Docs", "zeta", "Alpha.doc", "gamma.bin", "beta.txt"}));
+
+    core::SortListing(files, {core::SortColumn::Type, true}, order);
+    EXPECT_EQ(Names(files, order), (std::vector<std::string>{"Docs", "zeta", "gamma.bin", "Alpha.doc", "beta.txt"}));
+
+    core::SortListing(files, {core::SortColumn::Date, true}, order);
+    EXPECT_EQ(Names(files, order), (std::vector<std::string>{"zeta", "Docs", "gamma.bin", "beta.txt", "Alpha.doc"}));
+}
+
+TEST(ListingSortTests, FileExtension) {
+    EXPECT_EQ(core::FileExtension("a.tar.gz"), "gz");
+    EXPECT_EQ(core::FileExtension("README"), "");
+    EXPECT_EQ(core::FileExtension(".gitignore"), "");
+}
+
+TEST(ListingSortTests, PatchMatchesFullSort) {
+    std::mt19937 rng(7);
+    core::Listing files("root");
+    for (int i = 0; i < 200; ++i) {
+        files.Append("item" + std::to_string(i * 37 % 200) + (i % 3 ? ".txt" : ".bin"), i % 10 == 0, rng() % 500, true, rng() % 100);
+    }
+
+    // Drop a few, grow one, add a couple
+    core::Listing fresh("root");
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (i % 50 == 3) continue;
+        fresh.Append(files.Name(i), files.IsDir(i), i == 10 ? 999999 : files.Size(i), true, files.MTime(i));
+    }
+    fresh.Append("zz_new.txt", false, 5, true, 1);
+    fresh.Append("aa_new", true, 0, false, 1);
+
+    for (auto column : {core::SortColumn::Name, core::SortColumn::Size, core::SortColumn::Type, core::SortColumn::Date}) {
+        for (bool ascending : {true, false}) {
+            core::SortSpec spec{column, ascending};
+            core::Listing patched = files;
+            std::vector<uint32_t> order;
+            core::SortListing(patched, spec, order);
+            core::PatchListing(patched, order, spec, fresh, core::DiffListings(patched, fresh));
+
+            std::vector<uint32_t> expected;
+            core::SortListing(patched, spec, expected);
+            ASSERT_EQ(patched.size(), fresh.size());
+            EXPECT_EQ(Names(patched, order), Names(patched, expected));
+        }
+    }
+}
+
+TEST(ListingSortTests, LargeResortIsFast) {
+    core::Listing files("root");
+    std::mt19937 rng(42);
+    const size_t count = 500000;
+    files.reserve(count, count * 16);
+    for (size_t i = 0; i < count; ++i) {
+        files.Append("file_" + std::to_string(rng()) + ".dat", i % 50 == 0, rng(), true, rng());
+    }
+
+    std::vector<uint32_t> order;
+    auto start = std::chrono::steady_clock::now();
+    core::SortListing(files, {core::SortColumn::Size, true}, order);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(order.size(), count);
+    EXPECT_LT(ms, 1000); // Generous for debug builds; release is well under 100 ms
+}
+
+TEST(ListingSortTests, LargePatchIsFast) {
+    const size_t count = 200000;
+    const size_t added = count / 8; // Right at the patch threshold
+    core::Listing files("root");
+    core::Listing fresh("root");
+    for (size_t i = 0; i < count; ++i) {
+        files.Append("file" + std::to_string(i * 2) + ".txt", false, i, true, 0);
+        fresh.Append("file" + std::to_string(i * 2) + ".txt", false, i, true, 0);
+    }
+    for (size_t i = 0; i < added; ++i) {
+        fresh.Append("file" + std::to_string(i * 2 + 1) + ".txt", false, i, true, 0);
+    }
+
+    core::SortSpec spec{core::SortColumn::Name, true};
+    std::vector<uint32_t> order;
+    core::SortListing(files, spec, order);
+    core::ListingDiff diff = core::DiffListings(files, fresh);
+
+    auto start = std::chrono::steady_clock::now();
+    core::PatchListing(files, order, spec, fresh, diff);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<uint32_t> expected;
+    core::SortListing(files, spec, expected);
+    EXPECT_EQ(order, expected);
+    EXPECT_LT(ms, 1000); // Inserting one at a time took several times this
+}
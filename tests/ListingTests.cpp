@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "core/Listing.h"
+#include "core/FileSystem.h"
+
+TEST(ListingTests, AppendAndRead) {
+    core::Listing listing("C:/Data/");
+    listing.Append("notes.txt", false, 1536, true);
+    listing.Append("Projects", true, 0, false);
+
+    ASSERT_EQ(listing.size(), 2u);
+    EXPECT_EQ(listing.Name(0), "notes.txt");
+    EXPECT_STREQ(listing.NameCStr(1), "Projects");
+    EXPECT_FALSE(listing.IsDir(0));
+    EXPECT_TRUE(listing.IsDir(1));
+    EXPECT_TRUE(listing.SizeKnown(0));
+    EXPECT_EQ(listing.Size(0), 1536u);
+    EXPECT_EQ(listing.Path(0), "C:/Data/notes.txt");
+}
+
+TEST(ListingTests, AppendRangeFromOtherListing) {
+    core::Listing source("root");
+    for (int i = 0; i < 10; ++i) {
+        source.Append("f" + std::to_string(i), false, i, true);
+    }
+
+    core::Listing published("root");
+    published.Append(source, 0, 4);
+    published.Append(source, 4, 10);
+    ASSERT_EQ(published.size(), 10u);
+    EXPECT_EQ(published.Name(7), "f7");
+    EXPECT_EQ(published.Size(9), 9u);
+}
+
+TEST(ListingTests, PermuteReordersAllColumns) {
+    core::Listing listing("root");
+    listing.Append("a", false, 1, true);
+    listing.Append("b", true, 0, false);
+    listing.Append("c", false, 3, true);
+
+    listing.Permute({2, 0, 1});
+    EXPECT_EQ(listing.Name(0), "c");
+    EXPECT_EQ(listing.Size(0), 3u);
+    EXPECT_EQ(listing.Name(1), "a");
+    EXPECT_EQ(listing.Name(2), "b");
+    EXPECT_TRUE(listing.IsDir(2));
+}
+
+TEST(ListingTests, CompactPerEntryFootprint) {
+    core::Listing listing("root");
+    const size_t count = 100000;
+    listing.reserve(count, count * 16);
+    for (size_t i = 0; i < count; ++i) {
+        listing.Append("file_" + std::to_string(i) + ".obj", false, i, true);
+    }
+    // Fixed fields plus a short name and its collation key, well under the
+    // old ~100 bytes of std::strings plus heap-allocated paths per entry
+    EXPECT_LT(listing.MemoryUsage() / count, 72u);
+}
+
+TEST(ListingTests, DiffMatchesByName) {
+    core::Listing old_listing("root");
+    old_listing.Append("keep", false, 1, true, 10);
+    old_listing.Append("gone", false, 2, true, 10);
+    old_listing.Append("grew", false, 3, true, 10);
+
+    core::Listing fresh("root");
+    fresh.Append("grew", false, 30, true, 20);
+    fresh.Append("new", true, 0, false);
+    fresh.Append("keep", false, 1, true, 10);
+
+    auto diff = core::DiffListings(old_listing, fresh);
+    EXPECT_EQ(diff.removed, (std::vector<uint32_t>{1}));
+    EXPECT_EQ(diff.added, (std::vector<uint32_t>{1}));
+    ASSERT_EQ(diff.changed.size(), 1u);
+    EXPECT_EQ(diff.changed[0], std::make_pair(2u, 0u));
+    EXPECT_TRUE(core::DiffListings(fresh, fresh).empty());
+}
+
+TEST(ListingTests, EraseCompactsAndRemaps) {
+    core::Listing listing("root");
+    listing.Append("a", false, 1, true);
+    listing.Append("b", false, 2, true);
+    listing.Append("c", false, 3, true);
+
+    auto remap = listing.Erase({1});
+    ASSERT_EQ(listing.size(), 2u);
+    EXPECT_EQ(listing.Name(1), "c");
+    EXPECT_EQ(listing.Size(1), 3u);
+    EXPECT_EQ(remap, (std::vector<uint32_t>{0, core::kNoIndex, 1}));
+}
+
+TEST(ListingTests, DiffRestrictedToTouchedNames) {
+    core::Listing old_listing("root");
+    old_listing.Append("a", false, 1, true);
+    old_listing.Append("b", false, 2, true);
+    old_listing.Append("c", false, 3, true);
+
+    // b was deleted, c grew, d appeared; a was not touched
+    core::Listing fresh("root");
+    fresh.Append("c", false, 30, true);
+    fresh.Append("d", false, 4, true);
+
+    auto diff = core::DiffListings(old_listing, fresh, {"b", "c", "d"});
+    EXPECT_EQ(diff.removed, (std::vector<uint32_t>{1}));
+    EXPECT_EQ(diff.added, (std::vector<uint32_t>{1}));
+    ASSERT_EQ(diff.changed.size(), 1u);
+    EXPECT_EQ(diff.changed[0], std::make_pair(2u, 0u));
+}
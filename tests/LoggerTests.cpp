@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "core/Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class LoggerTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "flash_logger_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "log.txt").string();
+    }
+    void TearDown() override { fs::remove_all(dir); }
+
+    std::vector<std::string> Lines(const std::string& file) {
+        std::vector<std::string> lines;
+        std::ifstream in(file);
+        std::string line;
+        while (std::getline(in, line)) lines.push_back(line);
+        return lines;
+    }
+
+    fs::path dir;
+    std::string path;
+};
+
+}
+
+TEST_F(LoggerTests, WritesFromManyThreadsInTimeOrder) {
+    core::Logger logger;
+    ASSERT_TRUE(logger.Open(path));
+    logger.SetLevel(core::LogLevel::Debug);
+    logger.Write(core::LogLevel::Trace, "hidden");
+
+    const int kThreads = 4;
+    const int kPerThread = 500;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&logger, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                logger.Write(core::LogLevel::Info, "thread " + std::to_string(t) + " record " + std::to_string(i));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    logger.Close();
+
+    auto lines = Lines(path);
+    EXPECT_EQ(lines.size() + logger.Dropped(), static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(logger.Dropped(), 0u);
+    for (const auto& line : lines) {
+        EXPECT_NE(line.find("INFO  thread "), std::string::npos) << line;
+    }
+    // Batches are sorted by the time each record was made
+    std::vector<std::string> stamps;
+    for (const auto& line : lines) stamps.push_back(line.substr(0, line.find(']')));
+    EXPECT_TRUE(std::is_sorted(stamps.begin(), stamps.end()));
+}
+
+TEST_F(LoggerTests, RotatesPastMaxBytes) {
+    core::Logger logger;
+    ASSERT_TRUE(logger.Open(path, 4096, 2));
+    std::string text(200, 'x');
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 10; ++i) logger.Write(core::LogLevel::Error, text);
+        logger.Flush();
+    }
+    logger.Close();
+
+    EXPECT_TRUE(fs::exists(path + ".1"));
+    EXPECT_TRUE(fs::exists(path + ".2"));
+    EXPECT_FALSE(fs::exists(path + ".3"));
+    EXPECT_LT(fs::file_size(path + ".1"), 4096u + 10 * 256);
+}
+
+TEST_F(LoggerTests, CountsWhatAFullRingDrops) {
+    core::Logger logger;
+    ASSERT_TRUE(logger.Open(path));
+    // Without a drain in between the ring fills up
+    std::string text(1000, 'y');
+    size_t fits = core::Logger::kRingBytes / 1024;
+    for (size_t i = 0; i < fits * 2; ++i) logger.Write(core::LogLevel::Warn, text);
+    uint64_t dropped = logger.Dropped();
+    logger.Close();
+    auto lines = Lines(path);
+    ASSERT_FALSE(lines.empty());
+    EXPECT_EQ(lines.size() - (dropped ? 1 : 0) + dropped, fits * 2);
+}
+
+TEST_F(LoggerTests, KeepsRecordsMadeBeforeOpen) {
+    core::Logger logger;
+    logger.Write(core::LogLevel::Info, "early");
+    ASSERT_TRUE(logger.Open(path));
+    logger.Write(core::LogLevel::Info, "late");
+    logger.Close();
+    auto lines = Lines(path);
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("early"), std::string::npos);
+    EXPECT_NE(lines[1].find("late"), std::string::npos);
+}
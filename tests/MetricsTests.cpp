@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "core/Metrics.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+TEST(MetricsTests, CountersAddUpAcrossThreads) {
+    core::Metrics metrics;
+    core::Counter& counter = metrics.GetCounter("test.events");
+    EXPECT_EQ(&counter, &metrics.GetCounter("test.events")); // Same name, same counter
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 10000; ++i) counter.Add();
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(counter.Value(), 40000u);
+
+    core::Gauge& gauge = metrics.GetGauge("test.level");
+    gauge.Add(5);
+    gauge.Add(-2);
+    EXPECT_EQ(gauge.Value(), 3);
+}
+
+TEST(MetricsTests, HistogramBucketsCoverEveryValue) {
+    // Buckets tile the range without gaps or overlaps
+    for (int b = 0; b + 1 < core::Histogram::kBuckets; ++b) {
+        EXPECT_EQ(core::Histogram::BucketHigh(b), core::Histogram::BucketLow(b + 1)) << b;
+    }
+    for (uint64_t v : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull}) {
+        int b = core::Histogram::BucketOf(v);
+        EXPECT_GE(v, core::Histogram::BucketLow(b));
+        if (b + 1 < core::Histogram::kBuckets) {
+            EXPECT_LT(v, core::Histogram::BucketHigh(b));
+        }
+    }
+}
+
+TEST(MetricsTests, PercentilesStayWithinABucket) {
+    core::Histogram h;
+    EXPECT_EQ(h.Percentile(0.5), 0u);
+    // 1..10000 microseconds
+    for (uint64_t us = 1; us <= 10000; ++us) h.Record(us * 1000);
+    EXPECT_EQ(h.Count(), 10000u);
+    EXPECT_EQ(h.Max(), 10000u * 1000);
+    double tolerance = 1.0 / core::Histogram::kSubBuckets;
+    EXPECT_NEAR(h.Percentile(0.5) / 5e6, 1.0, tolerance);
+    EXPECT_NEAR(h.Percentile(0.99) / 9.9e6, 1.0, tolerance);
+    EXPECT_LE(h.Percentile(1.0), h.Max());
+}
+
+TEST(MetricsTests, DumpListsEveryMetric) {
+    core::Metrics metrics;
+    metrics.GetCounter("b.count").Add(7);
+    metrics.GetGauge("c.level").Set(-1);
+    metrics.GetHistogram("a.time").Record(2000000);
+
+    std::string path = (fs::temp_directory_path() / "flash_metrics_test.txt").string();
+    ASSERT_TRUE(metrics.DumpTo(path));
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    in.close();
+    fs::remove(path);
+
+    std::string text = ss.str();
+    EXPECT_EQ(text.find("# metrics at "), 0u);
+    EXPECT_NE(text.find("counter b.count 7\n"), std::string::npos);
+    EXPECT_NE(text.find("gauge c.level -1\n"), std::string::npos);
+    EXPECT_NE(text.find("histogram a.time count=1 mean=2.000ms"), std::string::npos);
+}
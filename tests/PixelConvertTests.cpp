@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "core/PixelConvert.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Every (colour, alpha) pair, with an odd tail so vector loops hand off
+std::vector<uint8_t> AllPairs() {
+    std::vector<uint8_t> bgra;
+    for (int a = 0; a < 256; ++a) {
+        for (int c = 0; c < 256; ++c) {
+            bgra.push_back(static_cast<uint8_t>(c));
+            bgra.push_back(static_cast<uint8_t>(255 - c));
+            bgra.push_back(static_cast<uint8_t>(c ^ 0x5A));
+            bgra.push_back(static_cast<uint8_t>(a));
+        }
+    }
+    for (int i = 0; i < 7 * 4; ++i) bgra.push_back(static_cast<uint8_t>(i * 37));
+    return bgra;
+}
+
+}
+
+TEST(PixelConvertTests, SwapsRedAndBlue) {
+    const uint8_t bgra[] = {1, 2, 3, 4, 10, 20, 30, 40};
+    uint8_t rgba[8];
+    core::ConvertBgraToRgba(bgra, rgba, 2);
+    const uint8_t expected[] = {3, 2, 1, 4, 30, 20, 10, 40};
+    EXPECT_EQ(std::memcmp(rgba, expected, sizeof(expected)), 0);
+}
+
+TEST(PixelConvertTests, PremultiplyRoundsToNearest) {
+    for (int a = 0; a < 256; ++a) {
+        for (int c = 0; c < 256; c += 15) {
+            const uint8_t px[] = {static_cast<uint8_t>(c), 0, 0, static_cast<uint8_t>(a)};
+            uint8_t out[4];
+            core::ConvertBgraToRgbaScalar(px, out, 1, true);
+            int exact = (c * a * 2 + 255) / 510; // round(c * a / 255)
+            ASSERT_EQ(out[2], exact) << "c=" << c << " a=" << a;
+            ASSERT_EQ(out[3], a);
+        }
+    }
+}
+
+TEST(PixelConvertTests, DispatchedKernelMatchesScalar) {
+    std::vector<uint8_t> src = AllPairs();
+    size_t pixels = src.size() / 4;
+    for (bool premultiply : {false, true}) {
+        std::vector<uint8_t> expected(src.size()), actual(src.size());
+        core::ConvertBgraToRgbaScalar(src.data(), expected.data(), pixels, premultiply);
+        core::ConvertBgraToRgba(src.data(), actual.data(), pixels, premultiply);
+        EXPECT_EQ(actual, expected) << core::PixelConvertKernel() << " premultiply=" << premultiply;
+
+        // In place, starting off alignment
+        std::vector<uint8_t> inplace(src.begin() + 4, src.end());
+        core::ConvertBgraToRgba(inplace.data(), inplace.data(), pixels - 1, premultiply);
+        EXPECT_TRUE(std::equal(inplace.begin(), inplace.end(), expected.begin() + 4));
+    }
+}
+
+TEST(PixelConvertTests, ReportsKernel) {
+    std::string kernel = core::PixelConvertKernel();
+    EXPECT_TRUE(kernel == "avx2" || kernel == "sse2" || kernel == "neon" || kernel == "scalar");
+}
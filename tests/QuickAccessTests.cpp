@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "../src/core/QuickAccess.h"
+#include "../src/core/FrecencyIndex.h"
+#include <algorithm>
+#include <random>
 #include <filesystem>
 #include <fstream>
 
@@ -8,6 +11,8 @@ protected:
     void SetUp() override {
         // Clean up any existing save file
         std::filesystem::remove("quick_access_test.txt");
+        // The shared instance loads on the pool
+        core::QuickAccess::Get().WaitUntilLoaded();
     }
 
     void TearDown() override {
@@ -59,3 +64,181 @@ TEST_F(QuickAccessTest, Pin_AddsToPinnedList) {
     qa.Unpin(path);
     EXPECT_FALSE(qa.IsPinned(path));
 }
+
+namespace {
+
+class QuickAccessJournalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() / "flash_quick_access_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        path = (dir / "quick_access.txt").string();
+        journal = (dir / "quick_access.journal").string();
+    }
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    int Score(core::QuickAccess& qa, const std::string& p) {
+        for (const auto& item : qa.GetItems(100)) {
+            if (item.path == p) return item.score;
+        }
+        return 0;
+    }
+
+    std::filesystem::path dir;
+    std::string path;
+    std::string journal;
+};
+
+}
+
+TEST_F(QuickAccessJournalTest, VisitsReplayFromTheJournal) {
+    {
+        core::QuickAccess qa(path);
+        qa.AddVisit("/a");
+        qa.AddVisit("/a");
+        qa.AddVisit("/b");
+        qa.Pin("/b");
+        EXPECT_TRUE(qa.Flush());
+    }
+    // Only appends so far; no snapshot was written
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_TRUE(std::filesystem::exists(journal));
+
+    core::QuickAccess qa(path);
+    EXPECT_EQ(Score(qa, "/a"), 2);
+    EXPECT_EQ(Score(qa, "/b"), 1);
+    EXPECT_TRUE(qa.IsPinned("/b"));
+}
+
+TEST_F(QuickAccessJournalTest, CompactionEmptiesTheJournal) {
+    {
+        core::QuickAccess qa(path);
+        for (size_t i = 0; i < core::QuickAccess::kCompactEntries; ++i) qa.AddVisit("/busy");
+        EXPECT_TRUE(qa.Flush());
+    }
+    EXPECT_TRUE(std::filesystem::exists(path));
+    EXPECT_EQ(std::filesystem::file_size(journal), 0u);
+
+    core::QuickAccess qa(path);
+    EXPECT_EQ(Score(qa, "/busy"), static_cast<int>(core::QuickAccess::kCompactEntries));
+}
+
+TEST_F(QuickAccessJournalTest, SkipsEntriesTheSnapshotHolds) {
+    {
+        core::QuickAccess qa(path);
+        qa.AddVisit("/a");
+        EXPECT_TRUE(qa.Flush());
+    }
+    // A crash after the snapshot rename leaves the old journal behind
+    std::string stale;
+    {
+        std::ifstream in(journal, std::ios::binary);
+        stale.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        core::QuickAccess qa(path);
+        qa.AddVisit("/a");
+        EXPECT_TRUE(qa.Save());
+    }
+    {
+        std::ofstream out(journal, std::ios::binary | std::ios::trunc);
+        out << stale << "99|V|/torn"; // Cut short before its newline
+    }
+
+    core::QuickAccess qa(path);
+    EXPECT_EQ(Score(qa, "/a"), 2);
+    EXPECT_EQ(Score(qa, "/torn"), 0);
+
+    // Numbering carries on past the snapshot
+    qa.AddVisit("/a");
+    EXPECT_TRUE(qa.Flush());
+    core::QuickAccess reloaded(path);
+    EXPECT_EQ(Score(reloaded, "/a"), 3);
+}
+
+TEST_F(QuickAccessJournalTest, SnapshotKeepsFrecencyAndReadsOldCounts) {
+    {
+        std::ofstream out(path);
+        out << "[Pinned]\n/pinned\n[Visits]\n/old|5\n/pinned|2\n";
+    }
+    int64_t day = 24 * 3600;
+    {
+        core::QuickAccess qa(path);
+        EXPECT_EQ(Score(qa, "/old"), 5);
+        qa.AddVisit("/new", 1000 * day);
+        EXPECT_TRUE(qa.Save());
+    }
+    core::QuickAccess qa(path);
+    auto items = qa.GetItems(3);
+    ASSERT_EQ(items.size(), 3u);
+    EXPECT_EQ(items[0].path, "/pinned");
+    EXPECT_TRUE(items[0].pinned);
+    EXPECT_EQ(items[0].score, 2);
+    // Five visits now outrank one long ago
+    EXPECT_EQ(items[1].path, "/old");
+    EXPECT_EQ(items[2].path, "/new");
+    EXPECT_EQ(items[2].last_visit, 1000 * day);
+    EXPECT_GT(items[1].frecency, items[2].frecency);
+}
+
+TEST(FrecencyIndexTests, RecentVisitsOutrankOldFrequentOnes) {
+    core::FrecencyIndex index;
+    int64_t now = 1700000000;
+    int64_t half_life = static_cast<int64_t>(core::FrecencyIndex::kHalfLifeSeconds);
+    for (int i = 0; i < 3; ++i) index.Visit("/old", now - 4 * half_life);
+    index.Visit("/recent", now);
+    index.Visit("/twice", now - half_life);
+    index.Visit("/twice", now - half_life);
+
+    EXPECT_NEAR(core::FrecencyIndex::Score(*index.Find("/recent"), now), 1.0, 1e-9);
+    EXPECT_NEAR(core::FrecencyIndex::Score(*index.Find("/twice"), now), 1.0, 1e-9);
+    EXPECT_NEAR(core::FrecencyIndex::Score(*index.Find("/old"), now), 3.0 / 16, 1e-9);
+
+    auto top = index.Top(2);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_NE(top[0]->path, "/old");
+    EXPECT_NE(top[1]->path, "/old");
+    EXPECT_EQ(index.Find("/old")->count, 3);
+}
+
+TEST(FrecencyIndexTests, TopMatchesAFullSort) {
+    core::FrecencyIndex index;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, 999);
+    std::uniform_int_distribution<int64_t> when(0, 365 * 24 * 3600);
+    for (int i = 0; i < 20000; ++i) index.Visit("/p" + std::to_string(pick(rng)), when(rng));
+
+    auto skip = [](const core::FrecencyIndex::Entry& e) { return e.path.size() == 3; }; // /p0 .. /p9
+    std::vector<const core::FrecencyIndex::Entry*> all;
+    for (const auto& e : index.Entries()) {
+        if (!skip(e)) all.push_back(&e);
+    }
+    std::sort(all.begin(), all.end(), [](auto a, auto b) { return a->key > b->key; });
+
+    auto top = index.Top(50, skip);
+    ASSERT_EQ(top.size(), 50u);
+    for (size_t i = 0; i < top.size(); ++i) EXPECT_EQ(top[i]->key, all[i]->key) << i;
+    EXPECT_EQ(index.Top(index.size() + 5).size(), index.size());
+}
+
+TEST_F(QuickAccessJournalTest, ChangesBeforeLoadingLandOnTopOfTheFiles) {
+    {
+        core::QuickAccess qa(path);
+        qa.AddVisit("/a");
+        qa.Pin("/a");
+        EXPECT_TRUE(qa.Flush());
+    }
+    core::TaskScheduler scheduler(1);
+    core::QuickAccess qa(path, scheduler, false);
+    qa.AddVisit("/a");
+    qa.Unpin("/a");
+    qa.WaitUntilLoaded();
+    EXPECT_EQ(Score(qa, "/a"), 2);
+    EXPECT_FALSE(qa.IsPinned("/a"));
+
+    EXPECT_TRUE(qa.Flush());
+    core::QuickAccess reloaded(path);
+    EXPECT_EQ(Score(reloaded, "/a"), 2);
+    EXPECT_FALSE(reloaded.IsPinned("/a"));
+}
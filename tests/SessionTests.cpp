@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "core/Session.h"
+#include "core/FileSystem.h"
+#include "core/TabContext.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class SessionTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = (fs::temp_directory_path() / "flash_session_test.bin").string();
+        fs::remove(path);
+    }
+    void TearDown() override { fs::remove(path); }
+
+    std::string path;
+};
+
+core::SessionTab Tab(const std::string& path, std::shared_ptr<const core::Listing> listing,
+                     std::shared_ptr<const std::vector<uint32_t>> order = nullptr) {
+    core::SessionTab tab;
+    tab.path = path;
+    tab.listing = std::move(listing);
+    tab.order = std::move(order);
+    return tab;
+}
+
+}
+
+TEST_F(SessionTests, RoundTripsTabsAndListings) {
+    auto listing = std::make_shared<core::Listing>("/home/user");
+    listing->Append("notes.txt", false, 1234, true, 1700000000, 3);
+    listing->Append("src", true, 0, false, 1700000100);
+    listing->Append("b.png", false, 99, true);
+
+    core::Session session;
+    core::SessionTab first;
+    first.path = "/home/user";
+    first.sort = {core::SortColumn::Size, false};
+    first.top_row = 2;
+    first.listing = listing;
+    first.order = std::make_shared<const std::vector<uint32_t>>(std::vector<uint32_t>{1, 0, 2});
+    session.tabs.push_back(first);
+    core::SessionTab second;
+    second.path = "/tmp"; // Was still loading
+    session.tabs.push_back(second);
+    session.active = 1;
+    ASSERT_TRUE(core::SaveSession(path, session));
+
+    core::Session loaded;
+    ASSERT_TRUE(core::LoadSession(path, loaded));
+    ASSERT_EQ(loaded.tabs.size(), 2u);
+    EXPECT_EQ(loaded.active, 1);
+
+    // Hidden tabs stay encoded until asked for
+    core::SessionTab& tab = loaded.tabs[0];
+    EXPECT_FALSE(tab.listing);
+    ASSERT_TRUE(tab.encoded);
+    ASSERT_TRUE(core::DecodeSessionTab(tab));
+    EXPECT_FALSE(tab.encoded);
+    EXPECT_EQ(tab.path, "/home/user");
+    EXPECT_TRUE(tab.sort == first.sort);
+    EXPECT_EQ(tab.top_row, 2);
+    ASSERT_TRUE(tab.listing);
+    ASSERT_EQ(tab.listing->size(), 3u);
+    EXPECT_EQ(tab.listing->Parent(), "/home/user");
+    EXPECT_EQ(tab.listing->Name(0), "notes.txt");
+    EXPECT_EQ(tab.listing->Size(0), 1234u);
+    EXPECT_EQ(tab.listing->MTime(0), 1700000000);
+    EXPECT_EQ(tab.listing->Attributes(0), 3);
+    EXPECT_TRUE(tab.listing->IsDir(1));
+    EXPECT_FALSE(tab.listing->SizeKnown(1));
+    EXPECT_EQ(tab.listing->Key(2), listing->Key(2));
+    EXPECT_EQ(tab.listing->Icon(2), listing->Icon(2));
+    ASSERT_TRUE(tab.order);
+    EXPECT_EQ(*tab.order, *first.order);
+
+    EXPECT_EQ(loaded.tabs[1].path, "/tmp");
+    EXPECT_FALSE(loaded.tabs[1].listing);
+}
+
+TEST_F(SessionTests, RejectsMissingAndDamagedFiles) {
+    core::Session loaded;
+    EXPECT_FALSE(core::LoadSession(path, loaded));
+
+    auto listing = std::make_shared<core::Listing>("/a");
+    for (int i = 0; i < 50; ++i) listing->Append("file" + std::to_string(i), false, i, true);
+    core::Session session;
+    session.tabs.push_back(Tab("/a", listing));
+    ASSERT_TRUE(core::SaveSession(path, session));
+
+    // Cut off inside the entries
+    fs::resize_file(path, fs::file_size(path) - 10);
+    EXPECT_FALSE(core::LoadSession(path, loaded));
+    EXPECT_TRUE(loaded.tabs.empty());
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a session file";
+    }
+    EXPECT_FALSE(core::LoadSession(path, loaded));
+}
+
+TEST_F(SessionTests, DamageInAHiddenTabOnlyCostsThatListing) {
+    auto listing = std::make_shared<core::Listing>("/a");
+    for (int i = 0; i < 4; ++i) listing->Append("file" + std::to_string(i), false, i, true);
+    auto order = std::make_shared<const std::vector<uint32_t>>(std::vector<uint32_t>{3, 2, 1, 0});
+    core::Session session;
+    session.tabs.push_back(Tab("/a", listing, order));
+    session.tabs.push_back(Tab("/b", listing, order));
+    session.active = 1;
+    ASSERT_TRUE(core::SaveSession(path, session));
+
+    // The hidden tab's order ends right before the next tab's header (24
+    // bytes) and path; point its last index out of range
+    std::string data;
+    {
+        std::ifstream in(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    size_t second_path = data.rfind("/b");
+    ASSERT_NE(second_path, std::string::npos);
+    uint32_t bad = 99;
+    std::memcpy(&data[second_path - 24 - sizeof(bad)], &bad, sizeof(bad));
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << data;
+    }
+
+    core::Session loaded;
+    ASSERT_TRUE(core::LoadSession(path, loaded));
+    ASSERT_TRUE(loaded.tabs[1].listing);
+    EXPECT_EQ(loaded.tabs[1].listing->size(), 4u);
+    EXPECT_FALSE(core::DecodeSessionTab(loaded.tabs[0]));
+    EXPECT_FALSE(loaded.tabs[0].listing);
+    EXPECT_FALSE(loaded.tabs[0].encoded);
+}
+
+TEST_F(SessionTests, HiddenTabsDecodeOnThePoolAndRevalidate) {
+    fs::path folder = fs::temp_directory_path() / "flash_session_restore_test";
+    fs::remove_all(folder);
+    fs::create_directories(folder);
+    for (const char* name : {"a.txt", "b.txt"}) std::ofstream(folder / name) << name;
+
+    // Saved with a file that has since gone
+    auto listing = std::make_shared<core::Listing>(folder.string());
+    for (const char* name : {"a.txt", "b.txt", "gone.txt"}) listing->Append(name, false, 5, true);
+    core::Session session;
+    session.tabs.push_back(Tab(folder.string(), listing));
+    session.tabs.push_back(Tab(folder.string(), nullptr));
+    session.active = 1;
+    ASSERT_TRUE(core::SaveSession(path, session));
+    core::Session loaded;
+    ASSERT_TRUE(core::LoadSession(path, loaded));
+    ASSERT_TRUE(loaded.tabs[0].encoded);
+
+    auto context = std::make_shared<core::TabContext>();
+    context->is_active = false;
+    core::RestoreTab(loaded.tabs[0], context);
+
+    for (int i = 0; i < 500 && context->is_loading; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(context->is_loading);
+    EXPECT_EQ(context->Snapshot()->size(), 2u);
+
+    context->generation++;
+    core::StopWatching(context);
+    fs::remove_all(folder);
+}
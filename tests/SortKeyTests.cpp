@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "core/SortKey.h"
+#include "core/ListingSort.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+bool KeyLess(const std::string& a, const std::string& b) {
+    return core::CompareKeys(core::CollationKey(a), core::CollationKey(b)) < 0;
+}
+
+}
+
+TEST(SortKeyTests, NaturalNumberOrder) {
+    EXPECT_TRUE(KeyLess("file9", "file10"));
+    EXPECT_TRUE(KeyLess("file2.txt", "file10.txt"));
+    EXPECT_TRUE(KeyLess("v1.9", "v1.10"));
+    EXPECT_FALSE(KeyLess("file10", "file9"));
+    // Leading zeros do not change the value
+    EXPECT_EQ(core::CollationKey("file007"), core::CollationKey("file7"));
+}
+
+TEST(SortKeyTests, CaseFolding) {
+    EXPECT_EQ(core::CollationKey("README"), core::CollationKey("readme"));
+    EXPECT_EQ(core::CollationKey("ÄRGER"), core::CollationKey("ärger"));
+    EXPECT_EQ(core::CollationKey("ΑΒΓ"), core::CollationKey("αβγ"));
+    EXPECT_EQ(core::CollationKey("ПРИВЕТ"), core::CollationKey("привет"));
+    EXPECT_EQ(core::CollationKey("ŁÓDŹ"), core::CollationKey("łódź"));
+    EXPECT_TRUE(KeyLess("apple", "Banana"));
+}
+
+TEST(SortKeyTests, InvalidUtf8IsKept) {
+    std::string bad = "a\xff" "b";
+    EXPECT_EQ(core::CollationKey(bad), bad);
+}
+
+TEST(SortKeyTests, RadixSortMatchesComparisonSort) {
+    core::Listing files("root");
+    std::mt19937 rng(7);
+    const char* stems[] = {"File", "file", "IMG_", "report", "Ärger", "z"};
+    const size_t count = 300000; // Large enough for the parallel radix path
+    for (size_t i = 0; i < count; ++i) {
+        std::string name = stems[rng() % 6] + std::to_string(rng() % 5000);
+        files.Append(name, false, 0, true);
+    }
+
+    std::vector<uint32_t> order;
+    core::SortListing(files, {core::SortColumn::Name, true}, order);
+
+    ASSERT_EQ(order.size(), count);
+    for (size_t i = 1; i < order.size(); ++i) {
+        int c = core::CompareKeys(files.Key(order[i - 1]), files.Key(order[i]));
+        ASSERT_LE(c, 0) << files.Name(order[i - 1]) << " vs " << files.Name(order[i]);
+        if (c == 0) {
+            ASSERT_LE(files.Name(order[i - 1]), files.Name(order[i]));
+        }
+    }
+}
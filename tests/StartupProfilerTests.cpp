@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "core/StartupProfiler.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+using Clock = core::StartupProfiler::Clock;
+
+TEST(StartupProfilerTests, ReportsPhasesInStartOrder) {
+    core::StartupProfiler profiler;
+    Clock::time_point start = Clock::now();
+    profiler.Begin(start);
+    profiler.Record("window", start + std::chrono::milliseconds(20), start + std::chrono::milliseconds(50));
+    profiler.Record("platform", start, start + std::chrono::milliseconds(10));
+    std::thread([&]() {
+        profiler.Record("logger", start + std::chrono::milliseconds(5), start + std::chrono::milliseconds(8));
+    }).join();
+
+    std::string report = profiler.Report();
+    EXPECT_NE(report.find("Startup took 50.0 ms"), std::string::npos) << report;
+    size_t platform = report.find("platform");
+    size_t logger = report.find("logger");
+    size_t window = report.find("window");
+    ASSERT_NE(window, std::string::npos);
+    EXPECT_LT(platform, logger);
+    EXPECT_LT(logger, window);
+    // Only phases off the UI thread are marked
+    EXPECT_EQ(report.find("(background)"), report.find("(background)", logger));
+    EXPECT_EQ(report.find("(background)", report.find('\n', logger)), std::string::npos);
+}
+
+TEST(StartupProfilerTests, FinishesOnceAndIgnoresLatePhases) {
+    core::StartupProfiler profiler;
+    profiler.Begin(Clock::now());
+    profiler.Mark("first_paint");
+    EXPECT_FALSE(profiler.Finished());
+    EXPECT_TRUE(profiler.Finish());
+    EXPECT_TRUE(profiler.Finished());
+    EXPECT_FALSE(profiler.Finish());
+
+    profiler.Mark("late");
+    EXPECT_EQ(profiler.Report().find("late"), std::string::npos);
+    EXPECT_NE(profiler.Report().find("first_paint"), std::string::npos);
+}
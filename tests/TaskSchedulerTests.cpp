@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "core/TaskScheduler.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(TaskSchedulerTests, RunsSubmittedTasks) {
+    core::TaskScheduler scheduler(2);
+    std::atomic<int> done{0};
+    for (int i = 0; i < 100; ++i) {
+        scheduler.Submit(core::TaskPriority::BackgroundTab, [&]() { done++; });
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (done < 100 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(done.load(), 100);
+}
+
+TEST(TaskSchedulerTests, VisibleWorkDoesNotWaitBehindBackground) {
+    core::TaskScheduler scheduler(2);
+
+    // Park every background slot on a task that only finishes when released
+    std::mutex m;
+    std::condition_variable cv;
+    bool release = false;
+    auto blocker = [&]() {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&]() { return release; });
+    };
+    scheduler.Submit(core::TaskPriority::Indexing, blocker);
+    scheduler.Submit(core::TaskPriority::Prefetch, blocker);
+
+    std::atomic<bool> visible_ran{false};
+    scheduler.Submit(core::TaskPriority::ActiveTab, [&]() { visible_ran = true; });
+
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!visible_ran && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_TRUE(visible_ran);
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        release = true;
+    }
+    cv.notify_all();
+}
+
+TEST(TaskSchedulerTests, ShutdownDropsQueuedTasks) {
+    core::TaskScheduler scheduler(2);
+
+    // Occupy every worker so the next task can only sit in the queue
+    std::mutex m;
+    std::condition_variable cv;
+    bool release = false;
+    std::atomic<int> blocked{0};
+    auto blocker = [&]() {
+        blocked++;
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&]() { return release; });
+    };
+    scheduler.Submit(core::TaskPriority::ActiveTab, blocker);
+    scheduler.Submit(core::TaskPriority::ActiveTab, blocker);
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (blocked < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_EQ(blocked.load(), 2);
+
+    std::atomic<int> ran{0};
+    scheduler.Submit(core::TaskPriority::ActiveTab, [&]() { ran++; });
+
+    // Shutdown joins the workers, so release them once it has begun
+    std::thread stopper([&]() { scheduler.Shutdown(); });
+    while (!scheduler.IsStopping()) std::this_thread::sleep_for(1ms);
+    {
+        std::lock_guard<std::mutex> lock(m);
+        release = true;
+    }
+    cv.notify_all();
+    stopper.join();
+    EXPECT_EQ(ran.load(), 0);
+
+    scheduler.Submit(core::TaskPriority::ActiveTab, [&]() { ran++; });
+    EXPECT_EQ(ran.load(), 0);
+    scheduler.Shutdown(); // Second call is a no-op
+}
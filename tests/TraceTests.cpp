@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "core/Trace.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string ReadAll(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+size_t Count(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++count;
+    return count;
+}
+
+}
+
+TEST(TraceTests, SpansOnlyRecordWhileEnabled) {
+    core::Tracer& tracer = core::Tracer::Get();
+    tracer.SetEnabled(false);
+    tracer.Clear();
+    { TRACE_SPAN("Off", "test"); }
+    EXPECT_EQ(tracer.EventCount(), 0u);
+
+    tracer.SetEnabled(true);
+    { TRACE_SPAN_DETAIL("On", "test", std::string("C:\\dir \"quoted\"")); }
+    std::thread worker([]() {
+        core::Tracer::Get().NameThread("Test worker");
+        TRACE_SPAN("OnWorker", "test");
+    });
+    worker.join();
+    tracer.SetEnabled(false);
+    EXPECT_EQ(tracer.EventCount(), 2u);
+
+    std::string path = (fs::temp_directory_path() / "flash_trace_test.json").string();
+    ASSERT_TRUE(tracer.ExportChromeJson(path));
+    std::string json = ReadAll(path);
+    fs::remove(path);
+    tracer.Clear();
+
+    EXPECT_EQ(json.find("{\"displayTimeUnit\""), 0u);
+    EXPECT_EQ(Count(json, "\"ph\":\"X\""), 2u);
+    EXPECT_NE(json.find("\"name\":\"OnWorker\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"Test worker\"}"), std::string::npos);
+    // Paths are escaped for JSON
+    EXPECT_NE(json.find("\"detail\":\"C:\\\\dir \\\"quoted\\\"\""), std::string::npos);
+}
+
+TEST(TraceTests, KeepsTheNewestSpansPerThread) {
+    core::Tracer tracer;
+    size_t extra = 10;
+    for (size_t i = 0; i < core::Tracer::kMaxEventsPerThread + extra; ++i) {
+        tracer.Record("Span", "test", static_cast<int64_t>(i) * 1000, static_cast<int64_t>(i) * 1000 + 500);
+    }
+    EXPECT_EQ(tracer.EventCount(), core::Tracer::kMaxEventsPerThread);
+
+    std::string path = (fs::temp_directory_path() / "flash_trace_ring_test.json").string();
+    ASSERT_TRUE(tracer.ExportChromeJson(path));
+    std::string json = ReadAll(path);
+    fs::remove(path);
+    // The oldest ones were overwritten and the rest come out in order
+    EXPECT_EQ(json.find("\"ts\":0.000,"), std::string::npos);
+    size_t first = json.find("\"ts\":" + std::to_string(extra) + ".000,");
+    size_t next = json.find("\"ts\":" + std::to_string(extra + 1) + ".000,");
+    ASSERT_NE(first, std::string::npos);
+    EXPECT_LT(first, next);
+}
+
+TEST(TraceTests, ExportDropsTheBuffersOfExitedThreads) {
+    core::Tracer tracer;
+    tracer.Record("Main", "test", 0, 500);
+    std::thread worker([&tracer]() { tracer.Record("Worker", "test", 1000, 1500); });
+    worker.join();
+    EXPECT_EQ(tracer.EventCount(), 2u);
+
+    std::string path = (fs::temp_directory_path() / "flash_trace_prune_test.json").string();
+    ASSERT_TRUE(tracer.ExportChromeJson(path));
+    EXPECT_NE(ReadAll(path).find("\"name\":\"Worker\""), std::string::npos);
+    // The worker's spans went out once; the live thread keeps its buffer
+    EXPECT_EQ(tracer.EventCount(), 1u);
+
+    ASSERT_TRUE(tracer.ExportChromeJson(path));
+    std::string json = ReadAll(path);
+    fs::remove(path);
+    EXPECT_EQ(json.find("\"name\":\"Worker\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"Main\""), std::string::npos);
+}
+
+TEST(TraceTests, ClearDropsTheBuffersOfExitedThreads) {
+    core::Tracer tracer;
+    std::thread worker([&tracer]() { tracer.Record("Worker", "test", 0, 500); });
+    worker.join();
+    tracer.Clear();
+    tracer.Record("Main", "test", 1000, 1500);
+
+    std::string path = (fs::temp_directory_path() / "flash_trace_clear_test.json").string();
+    ASSERT_TRUE(tracer.ExportChromeJson(path));
+    std::string json = ReadAll(path);
+    fs::remove(path);
+    // The worker was tid 1; the main thread registers after it was dropped
+    EXPECT_EQ(json.find("\"tid\":1,"), std::string::npos);
+    EXPECT_NE(json.find("\"tid\":2,"), std::string::npos);
+}
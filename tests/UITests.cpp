@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 #include "../src/ui/FileTable.h"
+#include "../src/ui/Sidebar.h"
 #include "../src/core/TabContext.h"
 #include "../src/core/FileSystem.h"
 #include <FL/Fl.H>
 #include <FL/Fl_Group.H>
+#include <algorithm>
+#include <filesystem>
 #include <memory>
 #include <thread>
 
@@ -29,7 +32,9 @@ protected:
 
 TEST_F(UITest, FileTable_DoubleClick_Directory) {
     auto context = std::make_shared<core::TabContext>();
-    context->files.push_back({"TestDir", "<DIR>", true, "C:/TestDir"});
+    auto files = std::make_shared<core::Listing>("C:/");
+    files->Append("TestDir", true, 0, false);
+    context->Publish(core::ListingSnapshot::Make(files, nullptr, context->sort, 1));
     
     // Create a window to hold the table (FLTK needs a window for events usually)
     Fl_Group* g = new Fl_Group(0, 0, 100, 100);
@@ -102,6 +107,127 @@ TEST_F(UITest, FileTable_DoubleClick_Directory) {
     // Let's just try to compile and run a basic test that creates the table.
     // If I can't simulate the click, I'll add a comment.
     
-    ASSERT_TRUE(context->files.size() > 0);
-    ASSERT_TRUE(context->files[0].is_dir);
+    auto snapshot = context->Snapshot();
+    ASSERT_TRUE(snapshot->size() > 0);
+    size_t i;
+    const core::Listing& listing = snapshot->Row(0, i);
+    ASSERT_TRUE(listing.IsDir(i));
+    ASSERT_EQ(listing.Path(i), "C:/TestDir");
+}
+
+// Sidebar over its own QuickAccess, emptied so the pins below are all it shows
+class SidebarTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() / "flash_sidebar_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        quick_access = std::make_unique<core::QuickAccess>((dir / "quick_access.txt").string());
+        for (const auto& item : quick_access->GetItems(100)) quick_access->Unpin(item.path);
+        for (const char* name : {"Alpha", "Beta", "Gamma"}) Pin(name);
+
+        group = new Fl_Group(0, 0, 200, 400);
+        sidebar = new ui::Sidebar(0, 0, 200, 400, *quick_access);
+        group->end();
+        // Refreshes are called by hand; an awake queued for the sidebar would outlive it
+        quick_access->SetUpdateCallback(nullptr);
+    }
+
+    void TearDown() override {
+        delete group; // Before the QuickAccess the sidebar listens to
+        quick_access.reset();
+        std::filesystem::remove_all(dir);
+    }
+
+    std::string Path(const char* name) { return (dir / name).string(); }
+    void Pin(const char* name) { quick_access->Pin(Path(name)); }
+    void Unpin(const char* name) { quick_access->Unpin(Path(name)); }
+
+    // Row buttons from top to bottom
+    std::vector<Fl_Widget*> Buttons() {
+        std::vector<Fl_Widget*> buttons;
+        for (int i = 0; i < sidebar->children(); ++i) {
+            Fl_Widget* child = sidebar->child(i);
+            if (child != &sidebar->scrollbar && child != &sidebar->hscrollbar) buttons.push_back(child);
+        }
+        std::sort(buttons.begin(), buttons.end(), [](Fl_Widget* a, Fl_Widget* b) { return a->y() < b->y(); });
+        return buttons;
+    }
+
+    std::vector<std::string> Labels() {
+        std::vector<std::string> labels;
+        for (Fl_Widget* button : Buttons()) labels.push_back(button->label());
+        return labels;
+    }
+
+    Fl_Widget* Button(const std::string& label) {
+        for (Fl_Widget* button : Buttons()) {
+            if (label == button->label()) return button;
+        }
+        return nullptr;
+    }
+
+    void ClearDamage() {
+        sidebar->clear_damage();
+        for (Fl_Widget* button : Buttons()) button->clear_damage();
+    }
+
+    std::filesystem::path dir;
+    std::unique_ptr<core::QuickAccess> quick_access;
+    Fl_Group* group = nullptr;
+    ui::Sidebar* sidebar = nullptr;
+};
+
+TEST_F(SidebarTest, ReordersByMovingTheSameButtons) {
+    ASSERT_EQ(Labels(), (std::vector<std::string>{"Alpha", "Beta", "Gamma"}));
+    Fl_Widget* alpha = Button("Alpha");
+    Fl_Widget* beta = Button("Beta");
+    Fl_Widget* gamma = Button("Gamma");
+
+    Unpin("Alpha");
+    Pin("Alpha"); // Now last
+    sidebar->Refresh();
+    ASSERT_EQ(Labels(), (std::vector<std::string>{"Beta", "Gamma", "Alpha"}));
+    EXPECT_EQ(Button("Alpha"), alpha);
+    EXPECT_EQ(Button("Beta"), beta);
+    EXPECT_EQ(Button("Gamma"), gamma);
+    EXPECT_LT(beta->y(), alpha->y());
+}
+
+TEST_F(SidebarTest, InsertAndRemoveKeepTheOtherButtons) {
+    Fl_Widget* alpha = Button("Alpha");
+    Fl_Widget* beta = Button("Beta");
+    Fl_Widget* gamma = Button("Gamma");
+
+    Pin("Delta");
+    sidebar->Refresh();
+    ASSERT_EQ(Labels(), (std::vector<std::string>{"Alpha", "Beta", "Gamma", "Delta"}));
+    EXPECT_EQ(Button("Alpha"), alpha);
+    EXPECT_EQ(Button("Beta"), beta);
+    EXPECT_EQ(Button("Gamma"), gamma);
+
+    Unpin("Beta");
+    sidebar->Refresh();
+    ASSERT_EQ(Labels(), (std::vector<std::string>{"Alpha", "Gamma", "Delta"}));
+    EXPECT_EQ(Button("Alpha"), alpha);
+    EXPECT_EQ(Button("Gamma"), gamma);
+    EXPECT_EQ(Buttons().size(), 3u); // Beta's button was deleted, not hidden
+}
+
+TEST_F(SidebarTest, UnchangedOrderRedrawsNothing) {
+    std::vector<Fl_Widget*> before = Buttons();
+    ClearDamage();
+
+    sidebar->Refresh();
+    EXPECT_EQ(Buttons(), before);
+    EXPECT_EQ(sidebar->damage(), 0);
+    for (Fl_Widget* button : Buttons()) EXPECT_EQ(button->damage(), 0);
+
+    // Only the rows that moved are redrawn
+    Unpin("Alpha");
+    Pin("Alpha");
+    ClearDamage();
+    sidebar->Refresh();
+    EXPECT_NE(Button("Alpha")->damage(), 0);
+    EXPECT_NE(Button("Beta")->damage(), 0);
 }
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "core/UpdateChannel.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(UpdateChannelTests, OnlyFirstPostAfterDrainWakes) {
+    core::UpdateChannel channel;
+    EXPECT_TRUE(channel.Post(core::kUpdateRows));
+    EXPECT_FALSE(channel.Post(core::kUpdateStatus));
+    EXPECT_FALSE(channel.Post(core::kUpdateRows));
+    EXPECT_EQ(channel.Take(), core::kUpdateRows | core::kUpdateStatus);
+    EXPECT_EQ(channel.Take(), 0u);
+    EXPECT_FALSE(channel.HasPending());
+
+    EXPECT_TRUE(channel.Post(core::kUpdateLocation));
+    EXPECT_EQ(channel.Take(), core::kUpdateLocation);
+    EXPECT_EQ(channel.PostCount(), 4u);
+    EXPECT_EQ(channel.DrainCount(), 2u);
+}
+
+TEST(UpdateChannelTests, EveryFlagIsDeliveredUnderContention) {
+    core::UpdateChannel channel;
+    std::atomic<int> wakeups{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&channel, &wakeups, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                if (channel.Post(1u << (t % 4))) wakeups++;
+            }
+        });
+    }
+
+    // Each wakeup is matched by exactly one non-empty drain
+    int drains = 0;
+    uint32_t seen = 0;
+    std::thread ui([&]() {
+        while (!done || channel.HasPending()) {
+            uint32_t flags = channel.Take();
+            if (flags) {
+                drains++;
+                seen |= flags;
+            }
+        }
+    });
+    for (auto& w : workers) w.join();
+    done = true;
+    ui.join();
+
+    EXPECT_EQ(drains, wakeups.load());
+    EXPECT_EQ(seen, 0xFu);
+}